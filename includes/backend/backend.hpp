@@ -1,10 +1,19 @@
 #pragma once
+#include "../common/physics_model.hpp"
+#include "../common/thermo_tables.hpp"
 #include <algorithm>
 #include <utility>
 #include <cmath>
 
 struct State;
 
+// Коэффициенты регуляторов. Значения по умолчанию - те, с которыми настраивалась симуляция.
+struct ControllerGains {
+    double temperature_band = 50.0; // K - ошибка, при которой регулятор выходит на полную мощность
+    double pressure_kp = 0.002;     // можно варьировать 0.001..0.01 для плавности
+    double humidity_kp = 0.5;       // доля ошибки влажности, исправляемая за секунду
+};
+
 class Sensor {
 private:
     struct Range {
@@ -40,6 +49,79 @@ public:
 };
 
 class TemperatureController : public Controller {    
+public:
+    // Члены прямой связи при нужной температуре, которые не меняются от тика к тику:
+    // зависят только от уставки, окружающей температуры и геометрии стенки.
+    // Конвекция (htc) и тепло реакции (масса) досчитываются из них каждый раз.
+    // Константы берутся из модели физики - те же, что у BasicThermodynamics<Model>.
+    struct FeedForwardInputs {
+        double needed;
+        double ambient;
+        double surface_area;
+        double wall_thickness;
+        double wall_thermal_conductivity;
+
+        bool operator==(const FeedForwardInputs&) const = default;
+    };
+
+    struct FeedForward {
+        double conduction = 0.0;    // потери через стенку
+        double radiation = 0.0;     // потери излучением, две pow(..., 4)
+        double rate_constant = 0.0; // k0 * exp(-Ea / (R * T_needed))
+        double heat_of_reaction = 0.0;
+
+        [[nodiscard]] double loss(double heat_transfer_coefficient, double surface_area, double needed,
+                                  double ambient) const {
+            double convection = heat_transfer_coefficient * surface_area * (needed - ambient);
+            return conduction + convection + radiation;
+        }
+
+        [[nodiscard]] double reaction_heat(double mass) const {
+            return rate_constant * mass * heat_of_reaction;
+        }
+    };
+
+    template<PhysicsModel Model = ReactorModel>
+    static FeedForward calculate_feed_forward(const FeedForwardInputs& in) {
+        FeedForward terms;
+        terms.conduction = (in.wall_thickness > 0.0)
+                               ? in.wall_thermal_conductivity * in.surface_area * (in.needed - in.ambient) / in.wall_thickness
+                               : 0.0;
+        terms.radiation = Model::STEFAN_BOLTZMANN * Model::EMISSIVITY * in.surface_area *
+                          (std::pow(in.needed, 4) - std::pow(in.ambient, 4));
+
+        double exp_term = (in.needed > 0.0)
+                              ? ThermoTables<Model>::arrhenius_factor(Model::ACTIVATION_ENERGY, Model::GAS_CONSTANT,
+                                                                      in.needed)
+                              : 0.0;
+        terms.rate_constant = Model::REACTION_RATE_CONSTANT * exp_term;
+        terms.heat_of_reaction = Model::HEAT_OF_REACTION;
+        return terms;
+    }
+
+    // Пересчитывает члены, только когда входы отличаются от прошлого вызова.
+    // Один кэш обслуживает одну модель физики
+    class FeedForwardCache {
+    private:
+        FeedForwardInputs inputs{};
+        FeedForward terms;
+        bool valid = false;
+
+    public:
+        template<PhysicsModel Model = ReactorModel>
+        const FeedForward& get(const FeedForwardInputs& current) {
+            if (!valid || !(current == inputs)) {
+                inputs = current;
+                terms = calculate_feed_forward<Model>(current);
+                valid = true;
+            }
+            return terms;
+        }
+    };
+
+private:
+    FeedForwardCache feed_forward;
+
 public:
     TemperatureController(double min, double max, bool control_state = true)
                         : Controller(Sensor({.min_value=min, .max_value=max}), control_state) {}
@@ -49,40 +131,37 @@ public:
     [[nodiscard]] double get_min_value() { return get_sensor().get_min_value(); }
     [[nodiscard]] double get_max_value() { return get_sensor().get_max_value(); }
 
-    template<typename T = State>
-    static std::pair<double, double> calculate_parallel_control_output(T& state) {
-        constexpr double STEFAN_BOLTZMANN = 5.670374419e-8;
-        constexpr double DEFAULT_EMISSIVITY = 0.1;
-        constexpr double GAS_CONSTANT = 8.314462618;
-        constexpr double REACTION_RATE_CONSTANT_DEFAULT = 1e-3;
-        constexpr double ACTIVATION_ENERGY_DEFAULT = 50000.0;
-        constexpr double HEAT_OF_REACTION_DEFAULT = 100000.0;
-
-        double heating_power = 0.0;
-        double cooling_power = 0.0;
+    template<PhysicsModel Model = ReactorModel, typename T = State>
+    std::pair<double, double> calculate_parallel_control_output(T& state,
+                                                                double band = ControllerGains{}.temperature_band) {
         double max_power = state.get_max_energy_consumption();
         double needed = state.get_needed_temperature();
         double current = state.get_temperature();
         double diff = needed - current;
         double ambient = state.get_ambient_temperature();
         double surface_area = state.get_surface_area();
-        double wall_thickness = state.get_wall_thickness();
-        double wall_thermal_conductivity = state.get_wall_thermal_conductivity();
-        double heat_transfer_coefficient = state.get_heat_transfer_coefficient();
-        double mass = state.get_mass();
 
-        double conduction = (wall_thickness > 0.0) ? wall_thermal_conductivity * surface_area * (needed - ambient) / wall_thickness : 0.0;
-        double convection = heat_transfer_coefficient * surface_area * (needed - ambient);
-        double radiation = STEFAN_BOLTZMANN * DEFAULT_EMISSIVITY * surface_area * (std::pow(needed, 4) - std::pow(ambient, 4));
-        double loss_needed = conduction + convection + radiation;
+        const FeedForward& terms = feed_forward.get<Model>({.needed = needed,
+                                                            .ambient = ambient,
+                                                            .surface_area = surface_area,
+                                                            .wall_thickness = state.get_wall_thickness(),
+                                                            .wall_thermal_conductivity = state.get_wall_thermal_conductivity()});
+
+        double loss_needed = terms.loss(state.get_heat_transfer_coefficient(), surface_area, needed, ambient);
+        double reac_needed = terms.reaction_heat(state.get_mass());
 
-        double exp_term = (needed > 0.0) ? std::exp(-ACTIVATION_ENERGY_DEFAULT / (GAS_CONSTANT * needed)) : 0.0;
-        double rate = REACTION_RATE_CONSTANT_DEFAULT * exp_term;
-        double reac_needed = rate * mass * HEAT_OF_REACTION_DEFAULT;
+        return calculate_parallel_control_output(diff, loss_needed, reac_needed, max_power, band);
+    }
 
+    // diff - ошибка по температуре, loss_needed/reac_needed - потери и тепло реакции при нужной температуре
+    static std::pair<double, double> calculate_parallel_control_output(double diff, double loss_needed,
+                                                                       double reac_needed, double max_power,
+                                                                       double band = ControllerGains{}.temperature_band) {
+        double heating_power = 0.0;
+        double cooling_power = 0.0;
         double required_heating = std::max(0.0, loss_needed - reac_needed);
         double required_cooling = std::max(0.0, reac_needed - loss_needed);
-        double kp = max_power / 50.0;
+        double kp = max_power / band;
 
         if (diff >= 0) {
             heating_power = required_heating + kp * diff;
@@ -111,31 +190,31 @@ public:
 
     // Ограничивает массовый поток по разумной фракции массы в секунду.
     template<typename T = State>
-    static double calculate_mass_flow_output(T& state, double delta_time) {
-        double gas_const = state.get_specific_gas_constant();
-        double volume = state.get_volume();
-        double temp = state.get_temperature();
-        double current_pressure = state.get_pressure();
-        double needed_pressure = state.get_needed_pressure();
+    static double calculate_mass_flow_output(T& state, double delta_time, double kp = ControllerGains{}.pressure_kp) {
+        return calculate_mass_flow_output(state.get_specific_gas_constant(), state.get_volume(),
+                                          state.get_temperature(), state.get_pressure(),
+                                          state.get_needed_pressure(), state.get_mass(), delta_time, kp);
+    }
 
+    static double calculate_mass_flow_output(double gas_const, double volume, double temp, double current_pressure,
+                                             double needed_pressure, double mass, double delta_time,
+                                             double kp = ControllerGains{}.pressure_kp) {
         if (gas_const <= 0.0 || volume <= 0.0 || temp <= 0.0 || delta_time <= 0.0) {
             return 0.0;
         }
 
         double pressure_error = needed_pressure - current_pressure;
 
-        // Коэффициент, определяющий "скорость реакции" системы на ошибку давления
-        constexpr double Kp = 0.002; // можно варьировать 0.001..0.01 для плавности
-
-        // Массовый поток (кг/с), пропорциональный ошибке давления
-        double mass_flow_rate = Kp * pressure_error * volume / (gas_const * temp);
+        // Массовый поток (кг/с), пропорциональный ошибке давления;
+        // kp определяет "скорость реакции" системы на ошибку давления
+        double mass_flow_rate = kp * pressure_error * volume / (gas_const * temp);
 
         // Изменение массы за этот шаг
         double mass_change = mass_flow_rate * delta_time;
 
         // Ограничение скорости (безопасный предел)
         constexpr double MAX_FRACTION_PER_SEC = 0.05;
-        double max_mass_change = state.get_mass() * MAX_FRACTION_PER_SEC * delta_time;
+        double max_mass_change = mass * MAX_FRACTION_PER_SEC * delta_time;
         mass_change = std::clamp(mass_change, -max_mass_change, max_mass_change);
 
         return mass_change;
@@ -153,17 +232,22 @@ public:
     [[nodiscard]] double get_max_value() { return get_sensor().get_max_value(); }
 
     template<typename T = State>
-    static double calculate_water_injection_rate(T& state, double delta_time, double max_possible_mass) {
-        double current = state.get_humidity();
-        double needed = state.get_needed_humidity();
+    static double calculate_water_injection_rate(T& state, double delta_time, double max_possible_mass,
+                                                 double kp = ControllerGains{}.humidity_kp) {
+        return calculate_water_injection_rate(state.get_humidity(), state.get_needed_humidity(), delta_time,
+                                              max_possible_mass, kp);
+    }
+
+    static double calculate_water_injection_rate(double current, double needed, double /*delta_time*/,
+                                                 double max_possible_mass,
+                                                 double kp = ControllerGains{}.humidity_kp) {
         double error = needed - current; // Если > 0, нужно увлажнять
 
-        // Коэффициент пропорциональности. 
+        // kp - коэффициент пропорциональности.
         // 0.1 означает: пытаемся исправить 10% ошибки за секунду.
-        constexpr double Kp = 0.5; 
 
         // Желаемая скорость изменения влажности (% в секунду)
-        double desired_humidity_change_speed = error * Kp;
+        double desired_humidity_change_speed = error * kp;
 
         // Превращаем проценты в массу воды (kg/s)
         // Если мы хотим изменить влажность на 5%, нам нужно добавить 0.05 * max_mass воды.
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <ostream>
+#include <string_view>
+
+// Проверки корректности для reactor-bench --check (их же запускает ctest): то, что замерами
+// не ловится, - границы ошибок ядер, отказоустойчивость тревог, круговой прогон форматов.
+namespace bench
+{
+	class Checker
+	{
+		std::ostream* log;
+		std::size_t	  passed = 0;
+		std::size_t	  failed = 0;
+
+	public:
+		explicit Checker(std::ostream& log) : log(&log) {}
+
+		// Непрошедшая проверка печатается в log сразу, прошедшие только считаются
+		void expect(bool condition, std::string_view what)
+		{
+			if (condition)
+			{
+				++passed;
+				return;
+			}
+			++failed;
+			*log << "FAILED: " << what << '\n';
+		}
+
+		[[nodiscard]] std::size_t get_passed() const
+		{
+			return passed;
+		}
+		[[nodiscard]] std::size_t get_failed() const
+		{
+			return failed;
+		}
+	};
+
+	// Все проверки; итог и непрошедшие - в log. true - всё прошло
+	bool run_checks(std::ostream& log);
+} // namespace bench
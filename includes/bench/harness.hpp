@@ -0,0 +1,201 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Минимальный харнесс микробенчмарков: калибровка числа итераций, несколько повторов,
+// медиана и разброс, результат в JSON для сравнения сборок.
+namespace bench
+{
+	// Не даёт компилятору выбросить вычисление, результат которого не используется
+	template <class T> inline void keep(const T& value)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r,m"(value) : "memory");
+#else
+		static const volatile T* sink;
+		sink = &value;
+#endif
+	}
+
+	struct Result
+	{
+		std::string	  name;
+		std::uint64_t iterations;	   // итераций в одном повторе
+		std::size_t	  repetitions;	   // сколько повторов
+		double		  ns_per_op;	   // медиана по повторам
+		double		  ns_per_op_min;
+		double		  ns_per_op_max;
+		double		  items_per_second; // items * 1e9 / ns_per_op
+	};
+
+	struct Settings
+	{
+		std::chrono::nanoseconds min_time{std::chrono::milliseconds(100)}; // длительность одного повтора
+		std::size_t				 repetitions = 5;
+		std::string				 filter;										// подстрока имени, пусто - все
+	};
+
+	class Runner
+	{
+		Settings			settings;
+		std::vector<Result> results;
+		std::ostream*		progress;
+
+		template <class Setup, class Body>
+		static std::chrono::nanoseconds measure(Setup& setup, Body& body, std::uint64_t iterations)
+		{
+			setup();
+			const auto start = std::chrono::steady_clock::now();
+			body(iterations);
+			return std::chrono::steady_clock::now() - start;
+		}
+
+	public:
+		// progress - куда печатать строку на каждый бенчмарк (nullptr - молча)
+		Runner(Settings settings, std::ostream* progress)
+			: settings(std::move(settings)), progress(progress)
+		{
+		}
+
+		[[nodiscard]] bool selected(std::string_view name) const
+		{
+			return settings.filter.empty() || name.find(settings.filter) != std::string_view::npos;
+		}
+
+		// body(n) выполняет измеряемую операцию n раз; items - сколько элементов (реакторов,
+		// отсчётов) обрабатывает одна операция
+		template <class Body> void run(const std::string& name, Body body, double items = 1.0)
+		{
+			run_with_setup(name, [] {}, body, items);
+		}
+
+		// setup() вызывается перед каждым замером и в него не входит. max_iterations - потолок
+		// калибровки, например для бенчмарков, которые растят файл
+		template <class Setup, class Body>
+		void run_with_setup(const std::string& name, Setup setup, Body body, double items = 1.0,
+							std::uint64_t max_iterations = std::numeric_limits<std::uint64_t>::max())
+		{
+			if (!selected(name))
+			{
+				return;
+			}
+
+			// Удваиваем число итераций, пока замер не станет достаточно длинным для таймера
+			std::uint64_t iterations = 1;
+			while (iterations < max_iterations)
+			{
+				const auto elapsed = measure(setup, body, iterations);
+				if (elapsed >= settings.min_time / 10)
+				{
+					const double scale = static_cast<double>(settings.min_time.count()) /
+										 static_cast<double>(std::max<std::int64_t>(elapsed.count(), 1));
+					iterations = static_cast<std::uint64_t>(static_cast<double>(iterations) * scale);
+					break;
+				}
+				iterations *= 2;
+			}
+			iterations = std::clamp<std::uint64_t>(iterations, 1, max_iterations);
+
+			std::vector<double> samples;
+			samples.reserve(settings.repetitions);
+			for (std::size_t repetition = 0; repetition < std::max<std::size_t>(settings.repetitions, 1);
+				 ++repetition)
+			{
+				samples.push_back(static_cast<double>(measure(setup, body, iterations).count()) /
+								  static_cast<double>(iterations));
+			}
+			std::sort(samples.begin(), samples.end());
+
+			Result result{.name				= name,
+						  .iterations		= iterations,
+						  .repetitions		= samples.size(),
+						  .ns_per_op		= samples[samples.size() / 2],
+						  .ns_per_op_min	= samples.front(),
+						  .ns_per_op_max	= samples.back(),
+						  .items_per_second = 0.0};
+			result.items_per_second = result.ns_per_op > 0.0 ? items * 1e9 / result.ns_per_op : 0.0;
+			results.push_back(result);
+
+			if (progress != nullptr)
+			{
+				*progress << name << ": " << result.ns_per_op << " ns/op (" << result.ns_per_op_min
+						  << " .. " << result.ns_per_op_max << ")\n";
+			}
+		}
+
+		[[nodiscard]] const std::vector<Result>& get_results() const
+		{
+			return results;
+		}
+
+		[[nodiscard]] const Settings& get_settings() const
+		{
+			return settings;
+		}
+	};
+
+	inline void write_json_string(std::ostream& out, std::string_view text)
+	{
+		out << '"';
+		for (char c : text)
+		{
+			switch (c)
+			{
+				case '"':
+					out << "\\\"";
+					break;
+				case '\\':
+					out << "\\\\";
+					break;
+				case '\n':
+					out << "\\n";
+					break;
+				default:
+					out << c;
+			}
+		}
+		out << '"';
+	}
+
+	// {"context": {...}, "benchmarks": [...]}; context - пары ключ/значение-строка
+	inline void write_json(std::ostream& out,
+						   const std::vector<std::pair<std::string, std::string>>& context,
+						   const std::vector<Result>& results)
+	{
+		const auto precision = out.precision(17);
+
+		out << "{\n  \"context\": {";
+		for (std::size_t i = 0; i < context.size(); ++i)
+		{
+			out << (i == 0 ? "\n    " : ",\n    ");
+			write_json_string(out, context[i].first);
+			out << ": ";
+			write_json_string(out, context[i].second);
+		}
+		out << "\n  },\n  \"benchmarks\": [";
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			const Result& result = results[i];
+			out << (i == 0 ? "\n    {" : ",\n    {");
+			out << "\"name\": ";
+			write_json_string(out, result.name);
+			out << ", \"iterations\": " << result.iterations
+				<< ", \"repetitions\": " << result.repetitions << ", \"ns_per_op\": " << result.ns_per_op
+				<< ", \"ns_per_op_min\": " << result.ns_per_op_min
+				<< ", \"ns_per_op_max\": " << result.ns_per_op_max
+				<< ", \"items_per_second\": " << result.items_per_second << "}";
+		}
+		out << "\n  ]\n}\n";
+
+		out.precision(precision);
+	}
+} // namespace bench
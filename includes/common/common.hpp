@@ -1,10 +1,21 @@
 #pragma once
 #include "../backend/backend.hpp"
+#include "history.hpp"
+#include "profiling.hpp"
+#include "seqlock.hpp"
 
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <mutex>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 enum class ControlMode : std::uint8_t
 {
@@ -19,6 +30,20 @@ enum class StatusMode : std::uint8_t
 	CRITICAL
 };
 
+constexpr std::string_view status_name(StatusMode mode)
+{
+	switch (mode)
+	{
+	case StatusMode::NORMAL:
+		return "normal";
+	case StatusMode::WARNING:
+		return "warning";
+	case StatusMode::CRITICAL:
+		return "critical";
+	}
+	return "unknown";
+}
+
 struct Environment
 {
 	double mass;				   // kg
@@ -45,6 +70,166 @@ struct Environment
 	double specific_gas_constant;
 };
 
+// Порядок совпадает с порядком полей Environment
+enum class EnvironmentField : std::uint8_t
+{
+	MASS,
+	VOLUME,
+	TEMPERATURE,
+	NEEDED_TEMPERATURE,
+	PRESSURE,
+	NEEDED_PRESSURE,
+	HUMIDITY,
+	NEEDED_HUMIDITY,
+	ENERGY_CONSUMPTION,
+	MAX_ENERGY_CONSUMPTION,
+	HEAT_CAPACITY,
+	THERMAL_CONDUCTIVITY,
+	SURFACE_AREA,
+	WALL_THICKNESS,
+	WALL_THERMAL_CONDUCTIVITY,
+	AMBIENT_TEMPERATURE,
+	HEAT_TRANSFER_COEFFICIENT,
+	REACTION_HEAT_RATE,
+	COOLING_RATE,
+	HEATING_RATE,
+	SPECIFIC_GAS_CONSTANT,
+};
+
+constexpr std::size_t ENVIRONMENT_FIELD_COUNT = 21;
+static_assert(sizeof(Environment) == ENVIRONMENT_FIELD_COUNT * sizeof(double));
+
+struct EnvironmentFieldInfo
+{
+	std::string_view name;
+	double Environment::* member;
+};
+
+constexpr std::array<EnvironmentFieldInfo, ENVIRONMENT_FIELD_COUNT> ENVIRONMENT_FIELDS{{
+	{.name = "mass", .member = &Environment::mass},
+	{.name = "volume", .member = &Environment::volume},
+	{.name = "temperature", .member = &Environment::temperature},
+	{.name = "needed_temperature", .member = &Environment::needed_temperature},
+	{.name = "pressure", .member = &Environment::pressure},
+	{.name = "needed_pressure", .member = &Environment::needed_pressure},
+	{.name = "humidity", .member = &Environment::humidity},
+	{.name = "needed_humidity", .member = &Environment::needed_humidity},
+	{.name = "energy_consumption", .member = &Environment::energy_consumption},
+	{.name = "max_energy_consumption", .member = &Environment::max_energy_consumption},
+	{.name = "heat_capacity", .member = &Environment::heat_capacity},
+	{.name = "thermal_conductivity", .member = &Environment::thermal_conductivity},
+	{.name = "surface_area", .member = &Environment::surface_area},
+	{.name = "wall_thickness", .member = &Environment::wall_thickness},
+	{.name = "wall_thermal_conductivity", .member = &Environment::wall_thermal_conductivity},
+	{.name = "ambient_temperature", .member = &Environment::ambient_temperature},
+	{.name = "heat_transfer_coefficient", .member = &Environment::heat_transfer_coefficient},
+	{.name = "reaction_heat_rate", .member = &Environment::reaction_heat_rate},
+	{.name = "cooling_rate", .member = &Environment::cooling_rate},
+	{.name = "heating_rate", .member = &Environment::heating_rate},
+	{.name = "specific_gas_constant", .member = &Environment::specific_gas_constant},
+}};
+
+constexpr const EnvironmentFieldInfo& field_info(EnvironmentField field)
+{
+	return ENVIRONMENT_FIELDS[static_cast<std::size_t>(field)];
+}
+
+// История всех полей Environment, по отсчёту на тик
+using History = BasicHistory<Environment, ENVIRONMENT_FIELD_COUNT>;
+
+constexpr std::size_t HISTORY_CAPACITY = 36000; // час симуляции при тике 100 мс, ~6 МБ
+
+constexpr History::Fields history_fields()
+{
+	History::Fields fields{};
+	for (std::size_t i = 0; i < ENVIRONMENT_FIELD_COUNT; ++i)
+	{
+		fields[i] = ENVIRONMENT_FIELDS[i].member;
+	}
+	return fields;
+}
+
+// Согласованная копия состояния на конец тика. Поток симуляции публикует её через
+// State::publish, TUI и другие читатели берут одну копию на кадр через State::snapshot
+struct Snapshot
+{
+	Environment	  environment{};
+	StatusMode	  status_mode	  = StatusMode::NORMAL;
+	ControlMode	  control_mode	  = ControlMode::AUTOMATICLY;
+	unsigned long sim_time_millis = 0;
+	std::uint64_t version		  = 0; // номер публикации, растёт на 1 за тик
+};
+
+// Номер "правила" у тревоги, которую поднимает сама симуляция, а не AlarmEngine
+constexpr std::uint32_t SOLVER_ALARM_RULE = UINT32_MAX;
+
+// Подъём или снятие тревоги (см. AlarmEngine)
+struct AlarmEvent
+{
+	std::string	  name;
+	std::uint32_t rule			  = 0; // номер правила в AlarmRules
+	StatusMode	  severity		  = StatusMode::WARNING;
+	bool		  raised		  = true; // false - тревога снята
+	double		  value			  = 0.0;  // значение поля (для правил скорости - скорость)
+	unsigned long sim_time_millis = 0;
+};
+
+// Журнал тревог для TUI и отчётов. Поток симуляции пишет только при событиях, а они
+// редки, поэтому хватает мьютекса; по version() читатель видит, что копировать нечего
+class AlarmLog
+{
+public:
+	static constexpr std::size_t CAPACITY = 256; // сколько последних событий хранится
+
+private:
+	mutable std::mutex		   mutex;
+	std::deque<AlarmEvent>	   events;
+	std::vector<AlarmEvent>	   active; // поднятые и ещё не снятые
+	std::atomic<std::uint64_t> changes{0};
+
+public:
+	void record(const AlarmEvent& event)
+	{
+		{
+			std::scoped_lock lock(mutex);
+			events.push_back(event);
+			if (events.size() > CAPACITY)
+			{
+				events.pop_front();
+			}
+			if (event.raised)
+			{
+				active.push_back(event);
+			}
+			else
+			{
+				std::erase_if(active, [&event](const AlarmEvent& alarm)
+							  { return alarm.rule == event.rule; });
+			}
+		}
+		changes.fetch_add(1, std::memory_order_release);
+	}
+
+	[[nodiscard]] std::uint64_t version() const
+	{
+		return changes.load(std::memory_order_acquire);
+	}
+
+	// Последние события, от старых к новым
+	[[nodiscard]] std::vector<AlarmEvent> recent() const
+	{
+		std::scoped_lock lock(mutex);
+		return {events.begin(), events.end()};
+	}
+
+	// В порядке подъёма
+	[[nodiscard]] std::vector<AlarmEvent> active_alarms() const
+	{
+		std::scoped_lock lock(mutex);
+		return active;
+	}
+};
+
 struct State
 {
 private:
@@ -56,10 +241,20 @@ private:
 	TemperatureController temp_controller;
 	PressureController	  pressure_controller;
 	HumidityController	  humidity_controller;
+	ControllerGains		  controller_gains;
 
 	std::atomic_bool running{false};
 	std::atomic_bool terminated{false};
 
+	// Будит поток симуляции при смене running/terminated
+	std::mutex				run_mutex;
+	std::condition_variable run_changed;
+
+	SeqLock<Snapshot> published;
+	History			  history{history_fields(), HISTORY_CAPACITY};
+	TickProfile		  profile;
+	AlarmLog		  alarm_log;
+
 public:
 	State(Environment environment, ControlMode control_mode, TemperatureController temp_controller,
 		  PressureController pressure_controller, HumidityController humidity_controller)
@@ -69,10 +264,43 @@ public:
 		  pressure_controller(std::move(pressure_controller)),
 		  humidity_controller(std::move(humidity_controller))
 	{
+		publish(0);
+	}
+
+	// Поля ниже читает и пишет только поток симуляции. Остальные потоки видят
+	// состояние через snapshot() и history_range(): копия целая и не блокирует симуляцию.
+	// Вызывается раз в тик: публикует снимок и добавляет отсчёт в историю
+	void publish(unsigned long sim_time_millis)
+	{
+		history.append(sim_time_millis, environment);
+		published.store(Snapshot{.environment	  = environment,
+								 .status_mode	  = status_mode,
+								 .control_mode	  = control_mode,
+								 .sim_time_millis = sim_time_millis,
+								 .version		  = published.version() + 1});
+	}
+
+	[[nodiscard]] Snapshot snapshot() const
+	{
+		return published.load();
+	}
+	// Номер последней публикации без копирования снимка: по нему TUI решает, пора ли рисовать
+	[[nodiscard]] std::uint64_t snapshot_version() const
+	{
+		return published.version();
+	}
+
+	// Отсчёты поля за from_millis <= t <= to_millis времени симуляции, из любого потока
+	[[nodiscard]] History::Series history_range(EnvironmentField field, unsigned long from_millis,
+												unsigned long to_millis) const
+	{
+		return history.range(static_cast<std::size_t>(field), from_millis, to_millis);
 	}
 
-	// Multithread safe access
-	std::mutex mutex; // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+	[[nodiscard]] const History& get_history() const
+	{
+		return history;
+	}
 
 	[[nodiscard]] bool is_running() const
 	{
@@ -81,7 +309,37 @@ public:
 
 	void set_running(bool new_value)
 	{
-		running.store(new_value);
+		{
+			std::scoped_lock lock(run_mutex);
+			running.store(new_value);
+		}
+		run_changed.notify_all();
+	}
+
+	// Ждёт запуска симуляции без нагрузки на процессор. false - симуляцию завершают
+	bool wait_until_running()
+	{
+		std::unique_lock lock(run_mutex);
+		run_changed.wait(lock, [this] { return running.load() || terminated.load(); });
+		return !terminated.load();
+	}
+
+	// Спит до deadline. Просыпается раньше и возвращает false, если симуляцию
+	// остановили или завершают
+	bool sleep_until(std::chrono::steady_clock::time_point deadline)
+	{
+		std::unique_lock lock(run_mutex);
+		return !run_changed.wait_until(lock, deadline,
+									   [this] { return !running.load() || terminated.load(); });
+	}
+
+	[[nodiscard]] Environment get_environment() const
+	{
+		return environment;
+	}
+	void set_environment(const Environment& new_environment)
+	{
+		environment = new_environment;
 	}
 
 	[[nodiscard]] double get_mass() const
@@ -275,6 +533,41 @@ public:
 		this->status_mode = status_mode;
 	}
 
+	// Пишет поток симуляции (AlarmEngine), читать можно из любого потока
+	[[nodiscard]] AlarmLog& get_alarm_log()
+	{
+		return alarm_log;
+	}
+	[[nodiscard]] const AlarmLog& get_alarm_log() const
+	{
+		return alarm_log;
+	}
+
+	// Пишет поток симуляции, читать можно из любого потока без блокировок
+	[[nodiscard]] TickProfile& get_profile()
+	{
+		return profile;
+	}
+	[[nodiscard]] const TickProfile& get_profile() const
+	{
+		return profile;
+	}
+
+	// Регулятор хранит кэш прямой связи, поэтому доступ неконстантный
+	[[nodiscard]] TemperatureController& get_temperature_controller()
+	{
+		return temp_controller;
+	}
+
+	[[nodiscard]] const ControllerGains& get_controller_gains() const
+	{
+		return controller_gains;
+	}
+	void set_controller_gains(const ControllerGains& gains)
+	{
+		controller_gains = gains;
+	}
+
 	[[nodiscard]] bool is_terminated() const
 	{
 		return terminated.load();
@@ -282,6 +575,10 @@ public:
 
 	void set_terminated(bool value)
 	{
-		terminated.store(value);
+		{
+			std::scoped_lock lock(run_mutex);
+			terminated.store(value);
+		}
+		run_changed.notify_all();
 	}
 };
@@ -0,0 +1,349 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+// Кольцевой буфер истории: FIELDS полей типа double из Sample с отметкой времени симуляции.
+// Память выделяется один раз в конструкторе, append() на горячем пути не выделяет память.
+// Пишет только поток симуляции, читать можно из любого потока без блокировок:
+// читатель копирует отрезок и отбрасывает отсчёты, которые писатель успел перезаписать.
+//
+// Поверх отсчётов хранится пирамида минимумов и максимумов: уровень k - корзины по FANOUT^k
+// отсчётов. Огибающую любого окна на ширину в W колонок envelope() собирает из корзин
+// за O(W * уровни), не проходя по всем отсчётам, и пики в ней не теряются.
+template <class Sample, std::size_t FIELDS> class BasicHistory
+{
+public:
+	using Fields = std::array<double Sample::*, FIELDS>;
+
+	static constexpr std::size_t FANOUT = 4;
+
+	// Отсчёты одного поля: times[i] - время симуляции в мс, values[i] - значение
+	struct Series
+	{
+		std::vector<unsigned long> times;
+		std::vector<double>		   values;
+	};
+
+	// Минимум и максимум поля в каждой колонке окна
+	struct Envelope
+	{
+		std::vector<double> minimum;
+		std::vector<double> maximum;
+	};
+
+private:
+	Fields		fields;
+	std::size_t slots;
+
+	// Отсчёт лежит строкой из FIELDS значений: append пишет несколько соседних кэш-линий
+	std::vector<std::atomic<unsigned long>> times;
+	std::vector<std::atomic<double>>		values;
+
+	// Уровень пирамиды: корзина bucket покрывает отсчёты [bucket * span, (bucket + 1) * span)
+	// и лежит в слоте bucket % buckets, строкой из FIELDS значений
+	struct Level
+	{
+		std::uint64_t					 span	 = 0;
+		std::size_t						 buckets = 0;
+		std::vector<std::atomic<double>> minimum;
+		std::vector<std::atomic<double>> maximum;
+	};
+	std::vector<Level> levels;
+
+	// Сколько отсчётов записано за всё время; слот отсчёта i - i % slots
+	std::atomic<std::uint64_t> written{0};
+
+	[[nodiscard]] double value_at(std::uint64_t index, std::size_t field) const
+	{
+		return values[((index % slots) * FIELDS) + field].load(std::memory_order_relaxed);
+	}
+
+	// Уровень 0 - сами отсчёты, уровень k > 0 - levels[k - 1]
+	[[nodiscard]] std::uint64_t span_of(std::size_t level) const
+	{
+		return level == 0 ? 1 : levels[level - 1].span;
+	}
+
+	[[nodiscard]] std::size_t buckets_of(std::size_t level) const
+	{
+		return level == 0 ? slots : levels[level - 1].buckets;
+	}
+
+	[[nodiscard]] std::pair<double, double> bucket_min_max(std::size_t level, std::uint64_t bucket,
+														   std::size_t field) const
+	{
+		if (level == 0)
+		{
+			double value = value_at(bucket, field);
+			return {value, value};
+		}
+		const Level&	  source = levels[level - 1];
+		const std::size_t cell	 = ((bucket % source.buckets) * FIELDS) + field;
+		return {source.minimum[cell].load(std::memory_order_relaxed),
+				source.maximum[cell].load(std::memory_order_relaxed)};
+	}
+
+	// Корзина уже записана при written == end и ещё не затёрта (писатель мог начать отсчёт end)
+	[[nodiscard]] bool bucket_usable(std::size_t level, std::uint64_t bucket, std::uint64_t end) const
+	{
+		const std::uint64_t span = span_of(level);
+		return (bucket + 1) * span <= end && bucket + buckets_of(level) >= (end + 1) / span;
+	}
+
+	// Писатель: дописан отсчёт count - 1, закрываем корзины, которые на нём кончились
+	void close_buckets(std::uint64_t count)
+	{
+		for (std::size_t level = 1; level <= levels.size(); ++level)
+		{
+			Level& target = levels[level - 1];
+			if (count % target.span != 0)
+			{
+				break;
+			}
+
+			const std::uint64_t bucket = (count / target.span) - 1;
+			const std::size_t	row	   = (bucket % target.buckets) * FIELDS;
+			for (std::size_t field = 0; field < FIELDS; ++field)
+			{
+				double low	= std::numeric_limits<double>::infinity();
+				double high = -std::numeric_limits<double>::infinity();
+				for (std::uint64_t child = bucket * FANOUT; child < (bucket + 1) * FANOUT; ++child)
+				{
+					auto [child_low, child_high] = bucket_min_max(level - 1, child, field);
+					low							 = std::min(low, child_low);
+					high						 = std::max(high, child_high);
+				}
+				target.minimum[row + field].store(low, std::memory_order_relaxed);
+				target.maximum[row + field].store(high, std::memory_order_relaxed);
+			}
+		}
+	}
+
+	[[nodiscard]] unsigned long time_at(std::uint64_t index) const
+	{
+		return times[index % slots].load(std::memory_order_relaxed);
+	}
+
+	// Первый логический индекс в [begin, end), для которого after(time) == true.
+	// Времена не убывают, поэтому after монотонен
+	template <class Predicate>
+	[[nodiscard]] std::uint64_t partition_point(std::uint64_t begin, std::uint64_t end,
+												Predicate after) const
+	{
+		while (begin < end)
+		{
+			std::uint64_t middle = begin + ((end - begin) / 2);
+			if (after(time_at(middle)))
+			{
+				end = middle;
+			}
+			else
+			{
+				begin = middle + 1;
+			}
+		}
+		return begin;
+	}
+
+	// Первый отсчёт, который читатель может взять при written == end: писатель мог уже
+	// начать отсчёт end, а он затирает слот отсчёта end - slots
+	[[nodiscard]] std::uint64_t first_readable(std::uint64_t end) const
+	{
+		return end + 1 > slots ? end + 1 - slots : 0;
+	}
+
+public:
+	BasicHistory(const Fields& fields, std::size_t capacity)
+		: fields(fields),
+		  slots(std::max<std::size_t>(capacity, 1)),
+		  times(slots),
+		  values(slots * FIELDS)
+	{
+		for (std::uint64_t span = FANOUT; span <= slots; span *= FANOUT)
+		{
+			Level level;
+			level.span	  = span;
+			level.buckets = slots / span;
+			level.minimum = std::vector<std::atomic<double>>(level.buckets * FIELDS);
+			level.maximum = std::vector<std::atomic<double>>(level.buckets * FIELDS);
+			levels.push_back(std::move(level));
+		}
+	}
+
+	BasicHistory(const BasicHistory&)			 = delete;
+	BasicHistory(BasicHistory&&)				 = delete;
+	BasicHistory& operator=(const BasicHistory&) = delete;
+	BasicHistory& operator=(BasicHistory&&)		 = delete;
+	~BasicHistory()								 = default;
+
+	// Только из одного потока-писателя
+	void append(unsigned long sim_time_millis, const Sample& sample)
+	{
+		const std::uint64_t index = written.load(std::memory_order_relaxed);
+		const std::size_t	slot  = index % slots;
+
+		times[slot].store(sim_time_millis, std::memory_order_relaxed);
+		std::atomic<double>* row = &values[slot * FIELDS];
+		for (std::size_t field = 0; field < FIELDS; ++field)
+		{
+			row[field].store(sample.*fields[field], std::memory_order_relaxed);
+		}
+		close_buckets(index + 1);
+
+		written.store(index + 1, std::memory_order_release);
+	}
+
+	[[nodiscard]] std::size_t capacity() const
+	{
+		return slots;
+	}
+
+	// Сколько отсчётов доступно читателю (не больше capacity() - 1 после заполнения)
+	[[nodiscard]] std::size_t size() const
+	{
+		const std::uint64_t end = written.load(std::memory_order_acquire);
+		return end - first_readable(end);
+	}
+
+	[[nodiscard]] std::uint64_t total_written() const
+	{
+		return written.load(std::memory_order_acquire);
+	}
+
+	// Время самого старого доступного отсчёта, 0 если истории нет
+	[[nodiscard]] unsigned long oldest_time() const
+	{
+		const std::uint64_t end = written.load(std::memory_order_acquire);
+		return end > 0 ? time_at(first_readable(end)) : 0;
+	}
+
+	// Время последнего отсчёта, 0 если истории нет
+	[[nodiscard]] unsigned long newest_time() const
+	{
+		const std::uint64_t end = written.load(std::memory_order_acquire);
+		return end > 0 ? time_at(end - 1) : 0;
+	}
+
+	// Отсчёты поля field со временем from_millis <= t <= to_millis, по возрастанию времени
+	[[nodiscard]] Series range(std::size_t field, unsigned long from_millis,
+							   unsigned long to_millis) const
+	{
+		Series series;
+		while (true)
+		{
+			const std::uint64_t end	  = written.load(std::memory_order_acquire);
+			const std::uint64_t begin = first_readable(end);
+
+			const std::uint64_t first =
+				partition_point(begin, end, [=](unsigned long time) { return time >= from_millis; });
+			const std::uint64_t last =
+				partition_point(first, end, [=](unsigned long time) { return time > to_millis; });
+
+			series.times.clear();
+			series.values.clear();
+			series.times.reserve(last - first);
+			series.values.reserve(last - first);
+			for (std::uint64_t index = first; index < last; ++index)
+			{
+				series.times.push_back(time_at(index));
+				series.values.push_back(value_at(index, field));
+			}
+
+			// Писатель обогнал читателя по кругу - поиск мог идти по затёртым слотам, повторяем
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (first >= first_readable(written.load(std::memory_order_relaxed)))
+			{
+				return series;
+			}
+		}
+	}
+
+	// Огибающая поля field на окне from_millis <= t <= to_millis, разбитом на columns колонок
+	// поровну по числу отсчётов. Если отсчётов меньше, чем колонок, отсчёт попадает в несколько
+	// колонок. Пустое окно - пустой результат.
+	[[nodiscard]] Envelope envelope(std::size_t field, unsigned long from_millis,
+									unsigned long to_millis, std::size_t columns) const
+	{
+		Envelope result;
+		while (true)
+		{
+			const std::uint64_t end	  = written.load(std::memory_order_acquire);
+			const std::uint64_t begin = first_readable(end);
+
+			const std::uint64_t first =
+				partition_point(begin, end, [=](unsigned long time) { return time >= from_millis; });
+			const std::uint64_t last =
+				partition_point(first, end, [=](unsigned long time) { return time > to_millis; });
+
+			result.minimum.clear();
+			result.maximum.clear();
+			if (first == last || columns == 0)
+			{
+				return result;
+			}
+			result.minimum.reserve(columns);
+			result.maximum.reserve(columns);
+
+			// Самая старая корзина, взятая на каждом уровне, - для проверки после чтения
+			std::vector<std::uint64_t> oldest(levels.size() + 1,
+											  std::numeric_limits<std::uint64_t>::max());
+
+			const std::uint64_t count = last - first;
+			for (std::size_t column = 0; column < columns; ++column)
+			{
+				std::uint64_t position = first + (count * column / columns);
+				std::uint64_t stop	   = std::max(first + (count * (column + 1) / columns), position + 1);
+
+				double low	= std::numeric_limits<double>::infinity();
+				double high = -std::numeric_limits<double>::infinity();
+				while (position < stop)
+				{
+					// Самая крупная целая корзина, которая начинается в position и влезает в колонку
+					std::size_t level = levels.size();
+					for (; level > 0; --level)
+					{
+						const std::uint64_t span = span_of(level);
+						if (position % span == 0 && position + span <= stop &&
+							bucket_usable(level, position / span, end))
+						{
+							break;
+						}
+					}
+
+					const std::uint64_t bucket = position / span_of(level);
+					auto [bucket_low, bucket_high] = bucket_min_max(level, bucket, field);
+					low							   = std::min(low, bucket_low);
+					high						   = std::max(high, bucket_high);
+					oldest[level]				   = std::min(oldest[level], bucket);
+					position += span_of(level);
+				}
+				result.minimum.push_back(low);
+				result.maximum.push_back(high);
+			}
+
+			// Писатель обогнал читателя по кругу - повторяем
+			std::atomic_thread_fence(std::memory_order_acquire);
+			const std::uint64_t now	   = written.load(std::memory_order_relaxed);
+			bool				intact = true;
+			for (std::size_t level = 0; level < oldest.size(); ++level)
+			{
+				if (oldest[level] != std::numeric_limits<std::uint64_t>::max() &&
+					oldest[level] + buckets_of(level) < (now + 1) / span_of(level))
+				{
+					intact = false;
+				}
+			}
+			if (intact)
+			{
+				return result;
+			}
+		}
+	}
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Таблица гладкой функции на отрезке [lower, upper]: равномерная сетка, в узлах - значение
+// и производная, между узлами - кубический полином Эрмита. Ошибка убывает как h^4, поэтому
+// даже для малой допустимой погрешности хватает нескольких тысяч узлов.
+// Пустая таблица (по умолчанию или если погрешность недостижима) не покрывает ни одной точки.
+class HermiteTable
+{
+	// slope - производная, уже умноженная на шаг сетки
+	struct Node
+	{
+		double value;
+		double slope;
+	};
+
+	double			  lower		   = 1.0;
+	double			  upper		   = 0.0;
+	double			  inverse_step = 0.0;
+	std::size_t		  intervals	   = 0;
+	std::vector<Node> nodes;
+
+	HermiteTable(double lower, double upper, std::size_t intervals)
+		: lower(lower),
+		  upper(upper),
+		  inverse_step(static_cast<double>(intervals) / (upper - lower)),
+		  intervals(intervals),
+		  nodes(intervals + 1)
+	{
+	}
+
+	// Оценка наибольшей относительной ошибки: три пробные точки внутри каждого интервала
+	template <class Function> [[nodiscard]] double measure_error(Function function) const
+	{
+		const double step		= (upper - lower) / static_cast<double>(intervals);
+		double		 worst		= 0.0;
+		const double offsets[3] = {0.25, 0.5, 0.75};
+		for (std::size_t interval = 0; interval < intervals; ++interval)
+		{
+			for (double offset : offsets)
+			{
+				const double x		 = lower + ((static_cast<double>(interval) + offset) * step);
+				const double exact	 = function(x);
+				const double error	 = std::abs((*this)(x) - exact);
+				const double scale	 = std::abs(exact);
+				const double measure = scale > 0.0 ? error / scale : error;
+				if (!(measure <= worst))
+				{
+					worst = measure; // NaN тоже считается худшим случаем
+				}
+			}
+		}
+		return worst;
+	}
+
+public:
+	static constexpr std::size_t MIN_INTERVALS = 16;
+	static constexpr std::size_t MAX_INTERVALS = std::size_t{1} << 20;
+
+	HermiteTable() = default;
+
+	// Удваивает сетку, пока оценка относительной ошибки (measure_error) не станет не больше
+	// relative_error. Это оценка, а не строгая граница: между пробными точками ошибка может
+	// быть немного больше. derivative - точная производная function. Не вышло до
+	// MAX_INTERVALS - пустая таблица
+	template <class Function, class Derivative>
+	[[nodiscard]] static HermiteTable build(Function function, Derivative derivative, double lower,
+											double upper, double relative_error)
+	{
+		if (!(lower < upper) || !(relative_error > 0.0))
+		{
+			return {};
+		}
+
+		for (std::size_t intervals = MIN_INTERVALS; intervals <= MAX_INTERVALS; intervals *= 2)
+		{
+			HermiteTable table(lower, upper, intervals);
+			const double step = (upper - lower) / static_cast<double>(intervals);
+			for (std::size_t i = 0; i <= intervals; ++i)
+			{
+				const double x = i == intervals ? upper : lower + (static_cast<double>(i) * step);
+				table.nodes[i] = {function(x), derivative(x) * step};
+			}
+
+			if (table.measure_error(function) <= relative_error)
+			{
+				return table;
+			}
+		}
+		return {};
+	}
+
+	[[nodiscard]] bool covers(double x) const
+	{
+		return x >= lower && x <= upper;
+	}
+
+	// Только для covers(x) == true
+	[[nodiscard]] double operator()(double x) const
+	{
+		const double	  position = (x - lower) * inverse_step;
+		const std::size_t interval = std::min(static_cast<std::size_t>(position), intervals - 1);
+		const double	  t		   = position - static_cast<double>(interval);
+
+		const Node&	 left		= nodes[interval];
+		const Node&	 right		= nodes[interval + 1];
+		const double difference = right.value - left.value;
+		return left.value +
+			   (t * (left.slope +
+					 (t * (((3.0 * difference) - (2.0 * left.slope) - right.slope) +
+						   (t * (right.slope + left.slope - (2.0 * difference)))))));
+	}
+
+	[[nodiscard]] std::size_t size() const
+	{
+		return nodes.size();
+	}
+};
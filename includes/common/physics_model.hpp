@@ -0,0 +1,88 @@
+#pragma once
+
+#include <concepts>
+
+// Модель физики реактора - набор constexpr констант и подмоделей, которыми параметризуются
+// BasicThermodynamics, ThermoTables и прямая связь TemperatureController. Каждая модель
+// (химия) компилируется в свои специализированные функции без ветвлений и виртуальных вызовов,
+// несколько моделей могут жить в одном бинарнике.
+template <class Model>
+concept PhysicsModel = requires {
+	// Физические константы
+	{ Model::STEFAN_BOLTZMANN } -> std::convertible_to<double>;
+	{ Model::GAS_CONSTANT } -> std::convertible_to<double>;
+
+	// Излучение стенки
+	{ Model::EMISSIVITY } -> std::convertible_to<double>;
+
+	// Смесь
+	{ Model::WATER_FRACTION } -> std::convertible_to<double>;
+	{ Model::ORGANIC_FRACTION } -> std::convertible_to<double>;
+	{ Model::mixture_heat_capacity(0.0, 0.0) } -> std::convertible_to<double>;
+
+	// Реакция по Аррениусу
+	{ Model::REACTION_RATE_CONSTANT } -> std::convertible_to<double>;
+	{ Model::ACTIVATION_ENERGY } -> std::convertible_to<double>;
+	{ Model::HEAT_OF_REACTION } -> std::convertible_to<double>;
+
+	// Теплоотдача по Диттусу-Бёлтеру
+	{ Model::VISCOSITY } -> std::convertible_to<double>;
+	{ Model::CHARACTERISTIC_LENGTH } -> std::convertible_to<double>;
+	{ Model::DITTUS_BOELTER_COEFFICIENT } -> std::convertible_to<double>;
+	{ Model::REYNOLDS_EXPONENT } -> std::convertible_to<double>;
+	{ Model::PRANDTL_EXPONENT } -> std::convertible_to<double>;
+
+	// Пар: уравнение Антуана log10(P_mmHg) = A - B / (C + T_celsius)
+	{ Model::MOLAR_MASS_WATER } -> std::convertible_to<double>;
+	{ Model::LATENT_HEAT_WATER } -> std::convertible_to<double>;
+	{ Model::ANTOINE_A } -> std::convertible_to<double>;
+	{ Model::ANTOINE_B } -> std::convertible_to<double>;
+	{ Model::ANTOINE_C } -> std::convertible_to<double>;
+	{ Model::ANTOINE_MIN_CELSIUS } -> std::convertible_to<double>;
+	{ Model::PASCAL_PER_MMHG } -> std::convertible_to<double>;
+	{ Model::MIN_SATURATION_PRESSURE } -> std::convertible_to<double>;
+};
+
+// Водно-органическая смесь - модель, с которой настраивалась симуляция
+struct AqueousOrganicModel
+{
+	static constexpr double STEFAN_BOLTZMANN = 5.670374419e-8;
+	static constexpr double GAS_CONSTANT	 = 8.314462618;
+
+	static constexpr double EMISSIVITY = 0.1;
+
+	static constexpr double WATER_FRACTION		  = 0.7;
+	static constexpr double ORGANIC_FRACTION	  = 0.3;
+	static constexpr double WATER_HEAT_CAPACITY	  = 4180.0;
+	static constexpr double ORGANIC_HEAT_CAPACITY = 2000.0;
+
+	static constexpr double mixture_heat_capacity(double water_fraction, double organic_fraction)
+	{
+		return (water_fraction * WATER_HEAT_CAPACITY) + (organic_fraction * ORGANIC_HEAT_CAPACITY);
+	}
+
+	static constexpr double REACTION_RATE_CONSTANT = 1e-3;
+	static constexpr double ACTIVATION_ENERGY	   = 50000.0;
+	static constexpr double HEAT_OF_REACTION	   = 100000.0;
+
+	static constexpr double VISCOSITY				   = 1e-3;
+	static constexpr double CHARACTERISTIC_LENGTH	   = 0.1;
+	static constexpr double DITTUS_BOELTER_COEFFICIENT = 0.023;
+	static constexpr double REYNOLDS_EXPONENT		   = 0.8;
+	static constexpr double PRANDTL_EXPONENT		   = 0.4;
+
+	// Вода, диапазон уравнения Антуана 1C - 374C
+	static constexpr double MOLAR_MASS_WATER		= 0.018015;
+	static constexpr double LATENT_HEAT_WATER		= 2260000.0;
+	static constexpr double ANTOINE_A				= 8.07131;
+	static constexpr double ANTOINE_B				= 1730.63;
+	static constexpr double ANTOINE_C				= 233.426;
+	static constexpr double ANTOINE_MIN_CELSIUS		= 1.0;
+	static constexpr double PASCAL_PER_MMHG			= 133.322;
+	static constexpr double MIN_SATURATION_PRESSURE = 0.1;
+};
+
+static_assert(PhysicsModel<AqueousOrganicModel>);
+
+// Модель, с которой собрано приложение: её используют Thermodynamics, State и интегратор
+using ReactorModel = AqueousOrganicModel;
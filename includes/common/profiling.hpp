@@ -0,0 +1,214 @@
+#pragma once
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Профилирование тика: время каждой стадии Simulation::simulate, всего тика и опоздание
+// начала тика относительно дедлайна (только в сборке с REACTOR_PROFILING, см. trace.hpp)
+
+// Гистограмма длительностей в наносекундах с логарифмическими корзинами: 4 корзины на
+// удвоение, ошибка квантиля не больше четверти значения. Пишет один поток (load + store,
+// без атомарных RMW), читать можно из любого потока без блокировок.
+class LogHistogram
+{
+public:
+	static constexpr unsigned	 SUB_BITS	 = 2;
+	static constexpr std::size_t SUB_BUCKETS = std::size_t{1} << SUB_BITS;
+	static constexpr std::size_t BUCKETS	 = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+	struct Summary
+	{
+		std::uint64_t count = 0;
+		std::uint64_t p50	= 0; // нс, верхняя граница корзины квантиля (не больше max)
+		std::uint64_t p99	= 0;
+		std::uint64_t max	= 0;
+	};
+
+private:
+	std::array<std::atomic<std::uint64_t>, BUCKETS> counts{};
+	std::atomic<std::uint64_t>						maximum{0};
+
+	static void bump(std::atomic<std::uint64_t>& counter)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+public:
+	// Значения меньше SUB_BUCKETS - по корзине на значение, дальше - SUB_BUCKETS на удвоение
+	static constexpr std::size_t bucket_of(std::uint64_t value)
+	{
+		if (value < SUB_BUCKETS)
+		{
+			return static_cast<std::size_t>(value);
+		}
+		const auto exponent = static_cast<unsigned>(std::bit_width(value)) - 1;
+		const auto mantissa = (value >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+		return ((exponent - SUB_BITS + 1) * SUB_BUCKETS) + static_cast<std::size_t>(mantissa);
+	}
+
+	// Наибольшее значение, попадающее в корзину
+	static constexpr std::uint64_t bucket_upper(std::size_t bucket)
+	{
+		if (bucket < SUB_BUCKETS)
+		{
+			return bucket;
+		}
+		const auto exponent = static_cast<unsigned>((bucket / SUB_BUCKETS) + SUB_BITS - 1);
+		const auto mantissa = static_cast<std::uint64_t>(bucket % SUB_BUCKETS);
+		const auto lower	= (SUB_BUCKETS + mantissa) << (exponent - SUB_BITS);
+		return lower + ((std::uint64_t{1} << (exponent - SUB_BITS)) - 1);
+	}
+
+	// Только из одного потока-писателя
+	void record(std::uint64_t nanoseconds)
+	{
+		bump(counts[bucket_of(nanoseconds)]);
+		if (nanoseconds > maximum.load(std::memory_order_relaxed))
+		{
+			maximum.store(nanoseconds, std::memory_order_relaxed);
+		}
+	}
+
+	// Снимок не атомарен целиком: во время записи count и квантили могут разойтись на отсчёт
+	[[nodiscard]] Summary summary() const
+	{
+		std::array<std::uint64_t, BUCKETS> copy{};
+		Summary							   result;
+		for (std::size_t bucket = 0; bucket < BUCKETS; ++bucket)
+		{
+			copy[bucket] = counts[bucket].load(std::memory_order_relaxed);
+			result.count += copy[bucket];
+		}
+		result.max = maximum.load(std::memory_order_relaxed);
+		if (result.count == 0)
+		{
+			return result;
+		}
+
+		auto quantile = [&](std::uint64_t rank)
+		{
+			std::uint64_t seen = 0;
+			for (std::size_t bucket = 0; bucket < BUCKETS; ++bucket)
+			{
+				seen += copy[bucket];
+				if (seen >= rank)
+				{
+					return std::min(bucket_upper(bucket), result.max);
+				}
+			}
+			return result.max;
+		};
+		// Ранги округляются вверх: p99 из 10 отсчётов - десятый
+		result.p50 = quantile((result.count + 1) / 2);
+		result.p99 = quantile(((result.count * 99) + 99) / 100);
+		return result;
+	}
+};
+
+enum class ProfileStage : std::uint8_t
+{
+	HUMIDITY,
+	TEMPERATURE,
+	PRESSURE,
+	INTEGRATOR, // совместный шаг T, P, влажности и массы (все схемы, кроме EULER)
+	PUBLISH,	// снимок, история, слушатели тиков
+	TICK,		// весь simulate()
+	JITTER,		// опоздание начала тика относительно дедлайна
+};
+
+constexpr std::size_t PROFILE_STAGE_COUNT = 7;
+
+constexpr std::array<std::string_view, PROFILE_STAGE_COUNT> PROFILE_STAGE_NAMES = {
+	"Humidity", "Temperature", "Pressure", "Integrator", "Publish", "Tick", "Jitter"};
+
+// Замеры включает цикл реального времени (Simulation::operator()): пакетный прогон и свипы
+// крутят миллионы тиков подряд, и чтение часов там заметно дороже самих стадий
+class TickProfile
+{
+	std::array<LogHistogram, PROFILE_STAGE_COUNT> histograms;
+	std::atomic_bool							  enabled{false};
+
+public:
+	[[nodiscard]] bool is_enabled() const
+	{
+		return PROFILING_ENABLED && enabled.load(std::memory_order_relaxed);
+	}
+	void set_enabled(bool value)
+	{
+		enabled.store(value, std::memory_order_relaxed);
+	}
+
+	void record(ProfileStage stage, std::chrono::nanoseconds duration)
+	{
+		if (is_enabled())
+		{
+			const auto count = duration.count();
+			histograms[static_cast<std::size_t>(stage)].record(
+				count > 0 ? static_cast<std::uint64_t>(count) : 0);
+		}
+	}
+
+	[[nodiscard]] LogHistogram::Summary summary(ProfileStage stage) const
+	{
+		return histograms[static_cast<std::size_t>(stage)].summary();
+	}
+};
+
+// Замеряет время от конструктора до деструктора: в гистограмму, если замеры включены,
+// и отрезком в трассу, если она пишется. Без REACTOR_PROFILING - пустой объект
+#ifdef REACTOR_PROFILING
+class ProfileScope
+{
+	TickProfile*						  profile;
+	ProfileStage						  stage;
+	bool								  trace;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	ProfileScope(TickProfile& profile, ProfileStage stage)
+		: profile(profile.is_enabled() ? &profile : nullptr),
+		  stage(stage),
+		  trace(Tracer::is_enabled())
+	{
+		if (this->profile != nullptr || trace)
+		{
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	ProfileScope(const ProfileScope&)			 = delete;
+	ProfileScope(ProfileScope&&)				 = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+	ProfileScope& operator=(ProfileScope&&)		 = delete;
+
+	~ProfileScope()
+	{
+		if (profile == nullptr && !trace)
+		{
+			return;
+		}
+		const auto end = std::chrono::steady_clock::now();
+		if (profile != nullptr)
+		{
+			profile->record(stage, end - start);
+		}
+		if (trace)
+		{
+			Tracer::record(PROFILE_STAGE_NAMES[static_cast<std::size_t>(stage)].data(), start, end);
+		}
+	}
+};
+#else
+class ProfileScope
+{
+public:
+	ProfileScope(TickProfile& /*profile*/, ProfileStage /*stage*/) {}
+};
+#endif
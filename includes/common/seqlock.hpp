@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Публикация значения одним писателем для любого числа читателей (seqlock).
+// Писатель никогда не ждёт: store() - это запись счётчика и слов значения.
+// Читатель без блокировок копирует значение и повторяет копию, если во время неё
+// писатель успел начать новую запись, поэтому рваного состояния он не увидит.
+// Значение хранится как массив атомарных слов: копирование без гонок данных в смысле стандарта.
+template <class T> class SeqLock
+{
+	static_assert(std::is_trivially_copyable_v<T>, "SeqLock needs a trivially copyable value");
+
+	using Word = std::uint64_t;
+
+	static constexpr std::size_t WORDS = (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+	// Чётный - значение целое, нечётный - писатель внутри store()
+	alignas(64) std::atomic<std::uint64_t> sequence{0};
+	std::array<std::atomic<Word>, WORDS> words{};
+
+public:
+	SeqLock() = default;
+	explicit SeqLock(const T& value)
+	{
+		store(value);
+	}
+
+	SeqLock(const SeqLock&)			   = delete;
+	SeqLock(SeqLock&&)				   = delete;
+	SeqLock& operator=(const SeqLock&) = delete;
+	SeqLock& operator=(SeqLock&&)	   = delete;
+	~SeqLock()						   = default;
+
+	// Только из одного потока-писателя
+	void store(const T& value)
+	{
+		std::array<Word, WORDS> raw{};
+		std::memcpy(raw.data(), &value, sizeof(T));
+
+		const std::uint64_t current = sequence.load(std::memory_order_relaxed);
+		sequence.store(current + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		for (std::size_t i = 0; i < WORDS; ++i)
+		{
+			words[i].store(raw[i], std::memory_order_relaxed);
+		}
+
+		sequence.store(current + 2, std::memory_order_release);
+	}
+
+	[[nodiscard]] T load() const
+	{
+		std::array<Word, WORDS> raw{};
+		std::uint64_t			before = 0;
+		std::uint64_t			after  = 0;
+		do
+		{
+			before = sequence.load(std::memory_order_acquire);
+			for (std::size_t i = 0; i < WORDS; ++i)
+			{
+				raw[i] = words[i].load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			after = sequence.load(std::memory_order_relaxed);
+		} while ((before & 1U) != 0 || before != after);
+
+		T value;
+		std::memcpy(static_cast<void*>(&value), raw.data(), sizeof(T));
+		return value;
+	}
+
+	// Сколько раз значение публиковалось
+	[[nodiscard]] std::uint64_t version() const
+	{
+		return sequence.load(std::memory_order_acquire) / 2;
+	}
+};
@@ -0,0 +1,57 @@
+#pragma once
+#include "lookup_table.hpp"
+#include "physics_model.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <utility>
+
+// Рабочий диапазон температур и целевая относительная ошибка таблиц (оценка, см.
+// HermiteTable::build; значение по умолчанию из конфигурации - TABLE_RELATIVE_ERROR).
+// relative_error <= 0 - таблицы не строятся, везде точные формулы
+struct ThermoTableSettings
+{
+	double min_temperature = 0.0;
+	double max_temperature = 0.0;
+	double relative_error  = 0.0;
+};
+
+// Таблицы самых горячих скалярных формул: давление насыщенного пара и множитель Аррениуса.
+// Строятся один раз при запуске (BasicThermodynamics::build_tables), вне таблицы - точная формула.
+// У каждой модели физики свои таблицы.
+template <PhysicsModel Model> class ThermoTables
+{
+	inline static std::unique_ptr<const ThermoTables> owner;
+	inline static std::atomic<const ThermoTables*>	  current{nullptr};
+
+public:
+	HermiteTable saturation_pressure; // Па от T, К
+	double		 arrhenius_ratio = 0.0; // Ea / R, для которого построена таблица arrhenius
+	HermiteTable arrhenius;				// exp(-Ea / (R * T)) от T, К
+
+	// Только до запуска потоков симуляции; nullptr - вернуться к точным формулам
+	static void install(std::unique_ptr<const ThermoTables> tables)
+	{
+		current.store(tables.get(), std::memory_order_release);
+		owner = std::move(tables);
+	}
+
+	[[nodiscard]] static const ThermoTables* active()
+	{
+		return current.load(std::memory_order_acquire);
+	}
+
+	// exp(-Ea / (R * T)): по таблице, если она построена для тех же Ea и R и покрывает T
+	[[nodiscard]] static double arrhenius_factor(double activation_energy, double gas_constant,
+												 double temperature)
+	{
+		const ThermoTables* tables = active();
+		if (tables != nullptr && activation_energy / gas_constant == tables->arrhenius_ratio &&
+			tables->arrhenius.covers(temperature))
+		{
+			return tables->arrhenius(temperature);
+		}
+		return std::exp(-activation_energy / (gas_constant * temperature));
+	}
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Профилирование и трассировка собираются, только если сборка с REACTOR_PROFILING
+// (опция CMake, по умолчанию включена); без неё замеры не компилируются вовсе.
+#ifdef REACTOR_PROFILING
+constexpr bool PROFILING_ENABLED = true;
+#else
+constexpr bool PROFILING_ENABLED = false;
+#endif
+
+struct TraceError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+// Отрезок времени на шкале потока. name - строковый литерал (хранится указатель)
+struct TraceEvent
+{
+	const char*	 name;
+	std::int64_t start;	   // нс от Tracer::start()
+	std::int64_t duration; // нс
+};
+
+// Буфер событий одного потока. Пишет только поток-владелец, без блокировок: событие
+// записывается в кусок, затем публикуется увеличением size. Куски выделяются по мере
+// заполнения и не перемещаются, поэтому читатель видит готовые события [0, size)
+class TraceBuffer
+{
+public:
+	static constexpr std::size_t CHUNK_EVENTS = std::size_t{1} << 12;
+	static constexpr std::size_t MAX_CHUNKS	  = 256; // не больше ~1M событий (24 МБ) на поток
+
+private:
+	std::array<std::atomic<TraceEvent*>, MAX_CHUNKS> chunks{};
+	std::vector<std::unique_ptr<TraceEvent[]>>		 owned; // только писатель
+	std::atomic<std::size_t>						 size{0};
+	std::atomic<std::uint64_t>						 dropped{0};
+
+public:
+	const std::uint32_t thread_id;
+	std::string			thread_name; // под мьютексом Tracer
+
+	explicit TraceBuffer(std::uint32_t thread_id)
+		: thread_id(thread_id), thread_name("thread " + std::to_string(thread_id))
+	{
+	}
+
+	void push(const TraceEvent& event)
+	{
+		const std::size_t index = size.load(std::memory_order_relaxed);
+		const std::size_t chunk = index / CHUNK_EVENTS;
+		if (chunk >= MAX_CHUNKS)
+		{
+			// Буфер полон: новые события теряются, старые остаются целыми
+			dropped.store(dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+		if (index % CHUNK_EVENTS == 0)
+		{
+			owned.push_back(std::make_unique<TraceEvent[]>(CHUNK_EVENTS));
+			chunks[chunk].store(owned.back().get(), std::memory_order_relaxed);
+		}
+		chunks[chunk].load(std::memory_order_relaxed)[index % CHUNK_EVENTS] = event;
+		size.store(index + 1, std::memory_order_release);
+	}
+
+	[[nodiscard]] std::size_t get_size() const
+	{
+		return size.load(std::memory_order_acquire);
+	}
+	[[nodiscard]] std::uint64_t get_dropped() const
+	{
+		return dropped.load(std::memory_order_relaxed);
+	}
+	// Только index < get_size()
+	[[nodiscard]] const TraceEvent& operator[](std::size_t index) const
+	{
+		return chunks[index / CHUNK_EVENTS].load(std::memory_order_relaxed)[index % CHUNK_EVENTS];
+	}
+};
+
+// Трассировка отрезков времени по потокам (тики, стадии, публикация снимка, кадры TUI)
+// с выгрузкой в формат Chrome trace-event JSON, который открывается в Perfetto
+// (ui.perfetto.dev) и chrome://tracing. Выключена - запись стоит одной relaxed-загрузки
+class Tracer
+{
+	inline static std::atomic_bool						   enabled{false};
+	inline static std::chrono::steady_clock::time_point	   origin;
+	inline static std::mutex							   mutex; // только регистрация и выгрузка
+	inline static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+
+	// Буферы живут до конца процесса: события завершившихся потоков тоже попадают в выгрузку
+	static TraceBuffer& local()
+	{
+		thread_local TraceBuffer* buffer = nullptr;
+		if (buffer == nullptr)
+		{
+			std::scoped_lock lock(mutex);
+			buffers.push_back(
+				std::make_unique<TraceBuffer>(static_cast<std::uint32_t>(buffers.size() + 1)));
+			buffer = buffers.back().get();
+		}
+		return *buffer;
+	}
+
+	static std::int64_t since_origin(std::chrono::steady_clock::time_point time)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(time - origin).count();
+	}
+
+	static void write_escaped(std::ostream& out, const std::string& text)
+	{
+		for (char c : text)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out << '\\';
+			}
+			out << c;
+		}
+	}
+
+public:
+	// Только до запуска потоков, которые пишут трассу
+	static void start()
+	{
+		if constexpr (PROFILING_ENABLED)
+		{
+			origin = std::chrono::steady_clock::now();
+			enabled.store(true, std::memory_order_release);
+		}
+	}
+	static void stop()
+	{
+		enabled.store(false, std::memory_order_release);
+	}
+
+	[[nodiscard]] static bool is_enabled()
+	{
+		return PROFILING_ENABLED && enabled.load(std::memory_order_relaxed);
+	}
+
+	// Имя дорожки текущего потока в просмотрщике; без трассировки ничего не делает
+	static void set_thread_name(std::string name)
+	{
+		if (is_enabled())
+		{
+			TraceBuffer&	 buffer = local();
+			std::scoped_lock lock(mutex);
+			buffer.thread_name = std::move(name);
+		}
+	}
+
+	static void record(const char* name, std::chrono::steady_clock::time_point start,
+					   std::chrono::steady_clock::time_point end)
+	{
+		if (is_enabled())
+		{
+			local().push({.name		= name,
+						  .start	= since_origin(start),
+						  .duration = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)
+										  .count()});
+		}
+	}
+
+	// {"traceEvents": [...]}: имена потоков (ph "M") и завершённые отрезки (ph "X"), время в мкс.
+	// Безопасно вызывать и при работающих писателях: выгружается то, что уже опубликовано
+	static void write_json(std::ostream& out)
+	{
+		constexpr double NANOS_IN_MICRO = 1000.0;
+
+		std::scoped_lock lock(mutex);
+		const auto		 precision = out.precision();
+		const auto		 flags	   = out.flags();
+		out.setf(std::ios::fixed);
+		out.precision(3);
+
+		std::uint64_t dropped = 0;
+		bool		  first	  = true;
+		out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+		for (const auto& buffer : buffers)
+		{
+			out << (first ? "\n" : ",\n") << R"({"name": "thread_name", "ph": "M", "pid": 1, "tid": )"
+				<< buffer->thread_id << R"(, "args": {"name": ")";
+			write_escaped(out, buffer->thread_name);
+			out << "\"}}";
+			first = false;
+
+			const std::size_t size = buffer->get_size();
+			for (std::size_t index = 0; index < size; ++index)
+			{
+				const TraceEvent& event = (*buffer)[index];
+				out << ",\n{\"name\": \"" << event.name << R"(", "ph": "X", "pid": 1, "tid": )"
+					<< buffer->thread_id
+					<< ", \"ts\": " << static_cast<double>(event.start) / NANOS_IN_MICRO
+					<< ", \"dur\": " << static_cast<double>(event.duration) / NANOS_IN_MICRO << "}";
+			}
+			dropped += buffer->get_dropped();
+		}
+		out << "\n], \"otherData\": {\"dropped_events\": \"" << dropped << "\"}}\n";
+
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	// Бросает TraceError, если файл не открылся или запись не удалась
+	static void write_file(const std::string& path)
+	{
+		std::ofstream out(path);
+		if (!out.is_open())
+		{
+			throw TraceError("Failed to open trace output: " + path);
+		}
+		write_json(out);
+		if (!out)
+		{
+			throw TraceError("Failed to write trace: " + path);
+		}
+	}
+};
+
+// Отрезок от конструктора до деструктора на дорожке текущего потока
+class TraceScope
+{
+	const char*							  name;
+	bool								  active;
+	std::chrono::steady_clock::time_point start;
+
+public:
+	explicit TraceScope(const char* name) : name(name), active(Tracer::is_enabled())
+	{
+		if (active)
+		{
+			start = std::chrono::steady_clock::now();
+		}
+	}
+
+	TraceScope(const TraceScope&)			 = delete;
+	TraceScope(TraceScope&&)				 = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+	TraceScope& operator=(TraceScope&&)		 = delete;
+
+	~TraceScope()
+	{
+		if (active)
+		{
+			Tracer::record(name, start, std::chrono::steady_clock::now());
+		}
+	}
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+// Настройки TUI из конфигурации ([tui]) и командной строки, их заполняет main
+struct TuiOptions
+{
+	double max_fps; // кадров в секунду не больше; кадр рисуется по вводу или новому снимку
+};
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <toml++/toml.hpp>
+#include <vector>
 
 constexpr double WALL_THERMAL_CONDUCTIVITY = 0.005;
 constexpr double AMBIENT_TEMPERATURE	   = 293.0;
@@ -9,6 +13,12 @@ constexpr double REACTION_HEAT_RATE		   = 0.0;
 constexpr double COOLING_RATE			   = 0.0;
 constexpr double HEATING_RATE			   = 15000.0;
 constexpr double SPECIFIC_GAS_CONSTANT	   = 287.0;
+constexpr double TABLE_RELATIVE_ERROR	   = 1e-10;
+constexpr double TUI_MAX_FPS			   = 30.0;
+constexpr double MIN_TUI_MAX_FPS		   = 0.1; // период 1 / max_fps должен помещаться в duration
+
+constexpr std::size_t STREAM_QUEUE_RECORDS	   = 4096;
+constexpr std::size_t MAX_STREAM_QUEUE_RECORDS = 1'048'576; // очередь выделяется сразу целиком
 
 struct ReactorConfig
 {
@@ -63,11 +73,83 @@ struct ReactionConfig
 	double max_humidity{};
 };
 
+// Таблицы давления насыщения и множителя Аррениуса на [min_temp, max_temp].
+// relative_error - целевая погрешность, проверяется по пробным точкам каждого интервала
+// (оценка, не строгая граница); <= 0 - всегда точные формулы
+struct TablesConfig
+{
+	double relative_error = TABLE_RELATIVE_ERROR;
+};
+
+// Периоды подсистем пошаговой схемы в мс времени симуляции; 0 - один шаг на тик
+struct RatesConfig
+{
+	unsigned long humidity_period_ms	= 0;
+	unsigned long temperature_period_ms = 0;
+	unsigned long pressure_period_ms	= 0;
+};
+
+// Перерисовка TUI не чаще max_fps кадров в секунду
+struct TuiConfig
+{
+	double max_fps = TUI_MAX_FPS;
+};
+
+// Что делает тик, когда очередь потоковой выдачи полна (писатель не успевает)
+enum class StreamPolicy : std::uint8_t
+{
+	BLOCK,		 // ждать места в очереди: без потерь, симуляция идёт со скоростью писателя
+	DROP_OLDEST, // выбросить самую старую запись очереди
+	DECIMATE,	 // писать каждую k-ю запись; k удваивается при переполнении и падает обратно,
+				 // когда писатель догнал
+};
+
+// Потоковая выдача тиков (--stream): ёмкость очереди в записях и политика при переполнении
+struct StreamConfig
+{
+	std::size_t	 queue_records = STREAM_QUEUE_RECORDS;
+	StreamPolicy policy		   = StreamPolicy::DROP_OLDEST;
+};
+
+enum class AlarmCondition : std::uint8_t
+{
+	ABOVE,		// значение > threshold
+	BELOW,		// значение < threshold
+	RATE_ABOVE, // скорость изменения, единиц/с, > threshold
+	RATE_BELOW, // скорость изменения, единиц/с, < threshold
+};
+
+enum class AlarmSeverity : std::uint8_t
+{
+	WARNING,
+	CRITICAL,
+};
+
+// Правило [[alarm]]: условие над полем Environment (имена как в CSV истории).
+// Тревога поднимается, когда условие держится for_ms мс симуляции, и снимается, когда
+// значение вернётся за порог с запасом hysteresis
+struct AlarmRuleConfig
+{
+	std::string		name;
+	std::string		field;
+	AlarmCondition	condition  = AlarmCondition::ABOVE;
+	double			threshold  = 0.0;
+	double			hysteresis = 0.0;
+	unsigned long	for_ms	   = 0;
+	AlarmSeverity	severity   = AlarmSeverity::WARNING;
+};
+
 struct AppConfig
 {
 	ReactorConfig  reactor{};
 	MassConfig	   mass{};
 	ReactionConfig reaction{};
+	TablesConfig   tables{};
+	RatesConfig	   rates{};
+	TuiConfig	   tui{};
+	StreamConfig   stream{};
+
+	std::vector<AlarmRuleConfig> alarms;
 };
 
 namespace cfg
@@ -75,4 +157,7 @@ namespace cfg
 	/// Load the config.
 	[[nodiscard]] AppConfig load_config(const std::string& path);
 	std::string				config_path();
+
+	/// block, drop-oldest or decimate; throws ConfigError otherwise.
+	[[nodiscard]] StreamPolicy parse_stream_policy(std::string_view name);
 } // namespace cfg
@@ -0,0 +1,207 @@
+#pragma once
+#include "../common/common.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+
+// Кольцо тиков в разделяемой памяти POSIX (shm_open) для процессов на той же машине:
+// историк, дашборды. Один писатель (поток симуляции), любое число читателей, которые
+// подключаются и отключаются когда угодно. Писатель читателей не ждёт и о них не знает:
+// отставший читатель теряет перезаписанные записи и узнаёт об этом по номерам.
+//
+// Раскладка (порядок байт - как у машины, которая пишет):
+//   ShmRingHeader: метка, число полей, ёмкость, имена полей, head - номер следующей записи
+//   capacity слотов ShmSlot: номер-seqlock и слова записи
+// Запись с номером s лежит в слоте s % capacity. Номер слота: 2s+1 - писатель внутри
+// записи s, 2s+2 - запись s целая (как у SeqLock, см. seqlock.hpp)
+
+constexpr std::array<char, 8> SHM_RING_MAGIC{'R', 'C', 'T', 'S', 'H', 'M', '0', '1'};
+constexpr std::size_t		  SHM_RING_NAME_LENGTH		= 32;
+constexpr std::size_t		  SHM_RING_DEFAULT_CAPACITY = 4096;
+
+// Слова записи: время симуляции (мс), StatusMode, затем поля Environment (биты double)
+constexpr std::size_t SHM_RECORD_TIME_WORD	 = 0;
+constexpr std::size_t SHM_RECORD_STATUS_WORD = 1;
+constexpr std::size_t SHM_RECORD_FIELD_WORD	 = 2;
+constexpr std::size_t SHM_RECORD_WORDS		 = SHM_RECORD_FIELD_WORD + ENVIRONMENT_FIELD_COUNT;
+
+struct ShmRingError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+			  "the ring needs address-free 64-bit atomics");
+
+struct ShmRingHeader
+{
+	std::array<char, 8> magic;
+	std::uint32_t		field_count;
+	std::uint32_t		record_words;
+	std::uint64_t		capacity; // степень двойки
+	std::array<std::array<char, SHM_RING_NAME_LENGTH>, ENVIRONMENT_FIELD_COUNT> names;
+
+	alignas(64) std::atomic<std::uint64_t> head; // номер следующей записи = сколько опубликовано
+	std::atomic<std::uint32_t> closed;			 // 1 - писатель завершился, новых записей не будет
+	std::int32_t			   writer_pid;		 // процесс-писатель, см. ShmRingWriter
+};
+
+struct ShmSlot
+{
+	alignas(64) std::atomic<std::uint64_t> sequence;
+	std::array<std::atomic<std::uint64_t>, SHM_RECORD_WORDS> words;
+};
+
+// Копия записи
+struct ShmRecord
+{
+	std::uint64_t sequence;
+	std::uint64_t sim_time_millis;
+	StatusMode	  status;
+	Environment	  environment;
+};
+
+// Записи публикует поток симуляции; создаёт объект name (вида "/reactor"). Прежний объект
+// с тем же именем заменяется, только если он закрыт или его писатель уже не работает (упал):
+// кольцо живого процесса не перехватывается. При разрушении помечает кольцо закрытым и удаляет
+// имя: подключённые читатели дочитывают своё отображение
+class ShmRingWriter
+{
+	int			   file		  = -1;
+	void*		   mapping	  = nullptr;
+	std::size_t	   mapped_bytes = 0;
+	ShmRingHeader* header	  = nullptr;
+	ShmSlot*	   slots	  = nullptr;
+	std::uint64_t  mask		  = 0;
+	std::uint64_t  next		  = 0;
+	std::string	   name;
+
+public:
+	// capacity округляется вверх до степени двойки. Бросает ShmRingError, в том числе если
+	// кольцо name ещё пишет другой работающий процесс
+	ShmRingWriter(const std::string& name, std::size_t capacity);
+
+	ShmRingWriter(const ShmRingWriter&)			   = delete;
+	ShmRingWriter(ShmRingWriter&&)				   = delete;
+	ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+	ShmRingWriter& operator=(ShmRingWriter&&)	   = delete;
+	~ShmRingWriter();
+
+	// Только из одного потока: несколько атомарных записей, без ожидания и системных вызовов
+	void publish(unsigned long sim_time_millis, StatusMode status, const Environment& env);
+
+	[[nodiscard]] std::uint64_t published() const
+	{
+		return next;
+	}
+};
+
+// Читатель кольца без копирования: peek() даёт вид на слот прямо в разделяемой памяти,
+// поля читаются оттуда по одному, а commit() проверяет, что писатель не перезаписал слот,
+// пока из него читали. Чтение никак не задерживает писателя
+class ShmRingReader
+{
+public:
+	// Вид на запись в слоте; значения действительны, только если commit(view) вернул true
+	class View
+	{
+		const ShmSlot* slot;
+		std::uint64_t  seq;
+		std::uint64_t  stamp; // номер слота при peek()
+
+		friend class ShmRingReader;
+
+		View(const ShmSlot* slot, std::uint64_t seq, std::uint64_t stamp)
+			: slot(slot), seq(seq), stamp(stamp)
+		{
+		}
+
+		[[nodiscard]] std::uint64_t word(std::size_t index) const
+		{
+			return slot->words[index].load(std::memory_order_relaxed);
+		}
+
+	public:
+		[[nodiscard]] std::uint64_t sequence() const
+		{
+			return seq;
+		}
+		[[nodiscard]] std::uint64_t sim_time_millis() const
+		{
+			return word(SHM_RECORD_TIME_WORD);
+		}
+		[[nodiscard]] StatusMode status() const
+		{
+			return static_cast<StatusMode>(word(SHM_RECORD_STATUS_WORD));
+		}
+		[[nodiscard]] double field(EnvironmentField field) const
+		{
+			return std::bit_cast<double>(
+				word(SHM_RECORD_FIELD_WORD + static_cast<std::size_t>(field)));
+		}
+	};
+
+private:
+	int					 file		  = -1;
+	const void*			 mapping	  = nullptr;
+	std::size_t			 mapped_bytes = 0;
+	const ShmRingHeader* header		  = nullptr;
+	const ShmSlot*		 slots		  = nullptr;
+	std::uint64_t		 mask		  = 0;
+	std::uint64_t		 cursor		  = 0; // номер следующей записи для чтения
+	std::uint64_t		 lost		  = 0;
+
+	// Курсор на самую старую запись, которую писатель ещё не начал перезаписывать
+	void skip_overwritten(std::uint64_t head);
+
+public:
+	// Подключается к кольцу name и встаёт на самую новую запись (старые можно прочитать после
+	// seek_oldest). Бросает ShmRingError, если кольца нет или его поля не совпадают с Environment
+	explicit ShmRingReader(const std::string& name);
+
+	ShmRingReader(const ShmRingReader&)			   = delete;
+	ShmRingReader(ShmRingReader&&)				   = delete;
+	ShmRingReader& operator=(const ShmRingReader&) = delete;
+	ShmRingReader& operator=(ShmRingReader&&)	   = delete;
+	~ShmRingReader();
+
+	// Следующая непрочитанная запись, если писатель её уже опубликовал
+	[[nodiscard]] std::optional<View> peek();
+
+	// true - всё, что прочитано через view, целое, курсор переходит к следующей записи.
+	// false - писатель перезаписал слот: прочитанное выбросить, курсор перескакивает
+	// на самую старую уцелевшую запись (пропущенные - в lost_records)
+	bool commit(const View& view);
+
+	// Копия следующей записи, повторяет чтение, если слот перезаписан
+	[[nodiscard]] std::optional<ShmRecord> next();
+
+	void seek_oldest();
+	void seek_latest();
+
+	// Опубликовано писателем всего, номер следующей его записи
+	[[nodiscard]] std::uint64_t head() const
+	{
+		return header->head.load(std::memory_order_acquire);
+	}
+	[[nodiscard]] std::uint64_t capacity() const
+	{
+		return mask + 1;
+	}
+	// Сколько записей пропущено из-за отставания
+	[[nodiscard]] std::uint64_t lost_records() const
+	{
+		return lost;
+	}
+	// Писатель завершился: после последней записи новых не будет
+	[[nodiscard]] bool is_closed() const
+	{
+		return header->closed.load(std::memory_order_acquire) != 0;
+	}
+};
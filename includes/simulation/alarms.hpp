@@ -0,0 +1,147 @@
+#pragma once
+#include "../common/common.hpp"
+#include "../config/config.hpp"
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct AlarmError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+// Диапазон датчика регулятора: выход поля за [min_value, max_value] - критическая тревога
+struct SensorRange
+{
+	std::string		 name;
+	EnvironmentField field;
+	double			 min_value;
+	double			 max_value;
+};
+
+struct AlarmRule
+{
+	std::string		 name;
+	EnvironmentField field;
+	AlarmCondition	 condition;
+	double			 threshold;
+	double			 hysteresis; // тревога снимается, когда значение отойдёт от порога на столько
+	unsigned long	 for_millis; // сколько условие должно держаться до подъёма
+	StatusMode		 severity;
+};
+
+// Скомпилированный набор правил: для каждого поля Environment - номера правил уровня
+// и скорости над ним. Неизменяем, поэтому один набор разделяют все реакторы парка
+class AlarmRules
+{
+	std::vector<AlarmRule>										   rules;
+	std::array<std::vector<std::uint32_t>, ENVIRONMENT_FIELD_COUNT> level_rules;
+	std::array<std::vector<std::uint32_t>, ENVIRONMENT_FIELD_COUNT> rate_rules;
+
+public:
+	// Правила из конфигурации плюс по два правила (ниже min, выше max) на датчик.
+	// Бросает AlarmError для неизвестного поля или повторяющегося имени
+	static std::shared_ptr<const AlarmRules> compile(const std::vector<AlarmRuleConfig>& configs,
+													 const std::vector<SensorRange>&	 sensors);
+
+	[[nodiscard]] std::size_t size() const
+	{
+		return rules.size();
+	}
+	[[nodiscard]] const AlarmRule& operator[](std::size_t index) const
+	{
+		return rules[index];
+	}
+	[[nodiscard]] const std::vector<std::uint32_t>& level_rules_of(std::size_t field) const
+	{
+		return level_rules[field];
+	}
+	[[nodiscard]] const std::vector<std::uint32_t>& rate_rules_of(std::size_t field) const
+	{
+		return rate_rules[field];
+	}
+};
+
+// Инкрементальная проверка правил одного реактора раз в тик. Правила поля пересчитываются,
+// только если поле изменилось (правила скорости - ещё и на тике после изменения, когда
+// скорость падает до нуля); сроки for_ms ждут в очереди по времени. Стоимость тика -
+// O(изменившихся полей и их правил + наступивших сроков), а не O(всех правил).
+// Тревога видна в конце того тика, на котором условие выполнилось (или истёк срок)
+class AlarmEngine
+{
+public:
+	struct RuleState
+	{
+		bool		  condition	 = false;
+		bool		  active	 = false;
+		std::uint32_t generation = 0;	// +1 при каждом снятии условия: старые сроки не в счёт
+		double		  value		 = 0.0; // последнее проверенное значение (или скорость)
+	};
+
+	struct Deadline
+	{
+		unsigned long due_millis;
+		std::uint32_t rule;
+		std::uint32_t generation;
+
+		bool operator>(const Deadline& other) const
+		{
+			return due_millis > other.due_millis;
+		}
+	};
+
+	// Состояние, переходящее из тика в тик. Нужно контрольным точкам: без него после
+	// восстановления сроки for_ms начинаются с нуля, а правила скорости видят на первом тике 0
+	struct Resume
+	{
+		std::vector<RuleState>					  states;
+		std::vector<Deadline>					  deadlines; // куча, как в движке
+		Environment								  previous{};
+		unsigned long							  previous_millis = 0;
+		bool									  primed		  = false;
+		std::array<bool, ENVIRONMENT_FIELD_COUNT> changed_last_tick{};
+	};
+
+private:
+	std::shared_ptr<const AlarmRules>		  rules;
+	std::vector<RuleState>					  states;
+	std::vector<Deadline>					  deadlines; // куча по due_millis (std::greater)
+	Environment								  previous{};
+	unsigned long							  previous_millis = 0;
+	bool									  primed		  = false;
+	std::array<bool, ENVIRONMENT_FIELD_COUNT> changed_last_tick{};
+	std::array<std::size_t, 2>				  active_counts{}; // WARNING, CRITICAL
+
+	void update_rule(std::uint32_t index, double value, unsigned long now, AlarmLog& log);
+	void raise(std::uint32_t index, double value, unsigned long now, AlarmLog& log);
+
+public:
+	explicit AlarmEngine(std::shared_ptr<const AlarmRules> rules);
+
+	// Заменяет правила; активные тревоги снимаются без событий, проверка начинается заново
+	void set_rules(std::shared_ptr<const AlarmRules> value);
+	[[nodiscard]] const std::shared_ptr<const AlarmRules>& get_rules() const
+	{
+		return rules;
+	}
+
+	// Вызывается в конце тика; возвращает статус - тяжесть самой серьёзной активной тревоги
+	StatusMode evaluate(unsigned long sim_time_millis, const Environment& env, AlarmLog& log);
+
+	[[nodiscard]] Resume get_resume() const
+	{
+		return {.states			   = states,
+				.deadlines		   = deadlines,
+				.previous		   = previous,
+				.previous_millis   = previous_millis,
+				.primed			   = primed,
+				.changed_last_tick = changed_last_tick};
+	}
+	// Только для тех же правил. Активные тревоги снова попадают в log (журнал не сохраняется).
+	// Бросает AlarmError, если число состояний не совпадает с числом правил
+	void set_resume(const Resume& resume, AlarmLog& log);
+};
@@ -0,0 +1,68 @@
+#pragma once
+#include "simulation.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// Контрольная точка: всё, от чего зависит следующий тик Simulation - Environment, режимы,
+// коэффициенты регуляторов, время симуляции, настройки, переходящее состояние и счётчики
+// интегратора, состояние движка тревог (сроки for_ms, прошлые значения для правил скорости)
+// и тревога несходимости неявной схемы.
+// Числа пишутся как есть (двоичное представление double), поэтому прогон, продолженный
+// из контрольной точки, совпадает с непрерывным бит в бит. Регуляторы - пропорциональные,
+// своего состояния, кроме коэффициентов, у них нет. История и телеметрия не сохраняются.
+
+struct CheckpointError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+// Пишет во временный файл рядом и переименовывает: прерванная запись не портит старую точку
+void save_checkpoint(const Simulation& simulation, const std::string& path);
+
+// Только до запуска потока симуляции. Бросает CheckpointError для чужого или битого файла
+void restore_checkpoint(Simulation& simulation, const std::string& path);
+
+// Слушатель тиков: пишет контрольную точку каждые interval_millis времени симуляции
+// и по запросу request() из любого потока (запись всё равно идёт в потоке симуляции).
+// Неудачная запись не останавливает симуляцию: она считается в get_failed()
+class Checkpointer
+{
+	Simulation&		   simulation;
+	std::string		   path;
+	unsigned long	   interval_millis;
+	unsigned long	   next_due;
+	std::atomic_bool   requested{false};
+	std::atomic_ulong  written{0}; // пишется в потоке симуляции, читается из других
+	unsigned long	   failed = 0;
+	std::string		   last_error;
+	mutable std::mutex error_mutex; // failed и last_error читаются из других потоков
+
+public:
+	Checkpointer(Simulation& simulation, std::string path, unsigned long interval_millis);
+
+	void request()
+	{
+		requested.store(true);
+	}
+
+	void operator()(unsigned long sim_time_millis, const Environment& env);
+
+	[[nodiscard]] unsigned long get_written() const
+	{
+		return written.load();
+	}
+	[[nodiscard]] unsigned long get_failed() const
+	{
+		const std::scoped_lock lock(error_mutex);
+		return failed;
+	}
+	// Текст последней ошибки записи; пусто, если ошибок не было
+	[[nodiscard]] std::string get_last_error() const
+	{
+		const std::scoped_lock lock(error_mutex);
+		return last_error;
+	}
+};
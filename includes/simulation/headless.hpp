@@ -0,0 +1,36 @@
+#pragma once
+#include "simulation.hpp"
+
+#include <ostream>
+
+// Прогон симуляции без TUI и без ожидания реального времени:
+// шаги фиксированной длины выполняются так быстро, как позволяет процессор.
+
+// Предел длительности (около 31700 лет): в миллисекундах она с запасом помещается в long long
+constexpr double MAX_BATCH_SECONDS = 1e12;
+struct BatchOptions
+{
+	double			   duration_seconds = 0.0;			// сколько секунд симулировать
+	unsigned long	   step_millis		= TIME_OF_TICK; // длина одного шага
+	IntegratorSettings integrator;					// схема интегрирования внутри шага
+};
+
+struct BatchReport
+{
+	double		  simulated_seconds = 0.0;
+	double		  wall_seconds		= 0.0;
+	unsigned long ticks				= 0;
+
+	// Сколько секунд симуляции проходит за секунду реального времени
+	[[nodiscard]] double speedup() const
+	{
+		return wall_seconds > 0.0 ? simulated_seconds / wall_seconds : 0.0;
+	}
+};
+
+[[nodiscard]] BatchReport run_batch(Simulation& simulation, const BatchOptions& options);
+
+void print_report(std::ostream& out, const Simulation& simulation, const BatchReport& report);
+
+// История (последние HISTORY_CAPACITY тиков) в CSV: time_ms и все поля Environment
+void write_history_csv(std::ostream& out, const History& history);
@@ -0,0 +1,200 @@
+#pragma once
+#include "../common/common.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+enum class IntegratorMode : std::uint8_t
+{
+	EULER,			// один явный шаг на тик, по очереди влажность -> температура -> давление
+	DORMAND_PRINCE, // RK45 с контролем ошибки и автоматическим выбором подшагов
+	BACKWARD_EULER, // неявная схема 1-го порядка, шаг = тик (или max_step)
+	BDF2,			// неявная схема 2-го порядка с переменным шагом, старт через BACKWARD_EULER
+};
+
+[[nodiscard]] std::string_view integrator_name(IntegratorMode mode);
+
+// Бросает std::invalid_argument для неизвестного имени
+[[nodiscard]] IntegratorMode parse_integrator_mode(std::string_view name);
+
+struct IntegratorSettings
+{
+	IntegratorMode mode				  = IntegratorMode::EULER;
+	double		   relative_tolerance = 1e-6;
+	double		   absolute_tolerance = 1e-6;
+	double		   min_step			  = 1e-6; // s, меньше не дробим даже при большой ошибке
+	double		   max_step			  = 0.0;  // s, 0 - без ограничения (неявные схемы: весь тик)
+
+	bool operator==(const IntegratorSettings&) const = default;
+};
+
+struct IntegratorStats
+{
+	unsigned long accepted_steps = 0;
+	unsigned long rejected_steps = 0;
+	unsigned long rhs_evaluations = 0;
+	unsigned long newton_iterations = 0;
+	unsigned long newton_failures = 0; // шаг неявной схемы не сошёлся и был поделён пополам
+	unsigned long failed_ticks = 0;	   // схема не справилась и на минимальном шаге, тик отменён
+};
+
+// T, P, влажность и масса реактора как одна система ОДУ dy/dt = f(y).
+// Остальные поля Environment (уставки, геометрия, константы) на шаге постоянны.
+// Регуляторы и члены Thermodynamics дают ту же физику, что и явная схема
+// Simulation::simulate, но без расщепления по подсистемам.
+class ReactorOde
+{
+public:
+	enum Index : std::uint8_t
+	{
+		TEMPERATURE,
+		PRESSURE,
+		HUMIDITY,
+		MASS,
+	};
+
+	static constexpr std::size_t DIMENSION = 4;
+	using Vector						   = std::array<double, DIMENSION>;
+	using Matrix						   = std::array<Vector, DIMENSION>;
+
+private:
+	Environment						   base;
+	ControllerGains					   gains;
+	TemperatureController::FeedForward feed_forward;
+
+public:
+	// feed_forward - члены прямой связи регулятора температуры для уставки и геометрии env
+	ReactorOde(const Environment& env, const ControllerGains& gains,
+			   const TemperatureController::FeedForward& feed_forward)
+		: base(env), gains(gains), feed_forward(feed_forward)
+	{
+	}
+	ReactorOde(const Environment& env, const ControllerGains& gains)
+		: ReactorOde(env, gains, TemperatureController::calculate_feed_forward(feed_forward_inputs(env)))
+	{
+	}
+
+	static TemperatureController::FeedForwardInputs feed_forward_inputs(const Environment& env)
+	{
+		return {.needed					   = env.needed_temperature,
+				.ambient				   = env.ambient_temperature,
+				.surface_area			   = env.surface_area,
+				.wall_thickness			   = env.wall_thickness,
+				.wall_thermal_conductivity = env.wall_thermal_conductivity};
+	}
+
+	// Давление приводится к уравнению состояния p = m*R*T/V
+	[[nodiscard]] Vector initial_state() const;
+
+	// p = m*R*T/V и его градиент по y. Неявные схемы решают уравнение состояния как
+	// алгебраическую связь: в dp/dt входит dT/dt, а у регулятора температуры разрыв на уставке.
+	[[nodiscard]] double gas_pressure(const Vector& y) const;
+	[[nodiscard]] Vector gas_pressure_gradient(const Vector& y) const;
+
+	[[nodiscard]] double needed_temperature() const
+	{
+		return base.needed_temperature;
+	}
+
+	[[nodiscard]] Vector derivative(const Vector& y) const;
+
+	// Аналитический якобиан: result[i][j] = d(dy_i/dt) / dy_j.
+	// Ограничения регуляторов дают кусочно-гладкую f, на насыщении производная берётся нулевой.
+	[[nodiscard]] Matrix jacobian(const Vector& y) const;
+
+	// Физические ограничения, которые явная схема накладывает после каждого шага
+	static void clamp(Vector& y);
+
+	// Записывает y и производные от него величины (мощности, теплоёмкость и т.п.) в env
+	void store(const Vector& y, Environment& env) const;
+};
+
+// Состояние интегратора, переходящее из тика в тик (без настроек и статистики).
+// Нужно контрольным точкам: продолженный прогон должен совпадать с непрерывным бит в бит
+struct IntegratorResume
+{
+	double			   step_hint = 0.0;
+	ReactorOde::Vector previous{};
+	ReactorOde::Vector last_output{};
+	double			   previous_step = 0.0;
+	bool			   has_history	 = false;
+};
+
+class Integrator
+{
+	IntegratorSettings settings;
+	IntegratorStats	   stats;
+	double			   step_hint = 0.0; // последний удачный подшаг, с него начинается следующий тик
+
+	// История неявных схем: BDF2 нужна точка y_{n-1}. Если состояние между тиками поменяли
+	// снаружи (last_output != текущее), история сбрасывается.
+	ReactorOde::Vector previous{};
+	ReactorOde::Vector last_output{};
+	double			   previous_step = 0.0;
+	bool			   has_history	 = false;
+	unsigned long	   failures_left = 0; // сколько ещё раз можно поделить шаг в текущем тике
+
+	// Уставка и геометрия меняются редко: прямая связь считается только при их смене
+	TemperatureController::FeedForwardCache feed_forward;
+
+	bool dormand_prince(const ReactorOde& ode, ReactorOde::Vector& y, double duration);
+	bool implicit(const ReactorOde& ode, ReactorOde::Vector& y, double duration);
+	bool implicit_step(const ReactorOde& ode, ReactorOde::Vector& y, double step);
+	bool newton(const ReactorOde& ode, ReactorOde::Vector& y, const ReactorOde::Vector& constant,
+				double gamma);
+	bool newton_iterate(const ReactorOde& ode, ReactorOde::Vector& y,
+						const ReactorOde::Vector& constant, double gamma, bool sliding);
+
+public:
+	Integrator() = default;
+	explicit Integrator(const IntegratorSettings& settings) : settings(settings) {}
+
+	[[nodiscard]] const IntegratorSettings& get_settings() const
+	{
+		return settings;
+	}
+	// Те же настройки - состояние между тиками сохраняется (например, после контрольной точки)
+	void set_settings(const IntegratorSettings& new_settings)
+	{
+		if (new_settings == settings)
+		{
+			return;
+		}
+		settings	= new_settings;
+		step_hint	= 0.0;
+		has_history = false;
+	}
+
+	[[nodiscard]] const IntegratorStats& get_stats() const
+	{
+		return stats;
+	}
+	void set_stats(const IntegratorStats& new_stats)
+	{
+		stats = new_stats;
+	}
+
+	[[nodiscard]] IntegratorResume get_resume() const
+	{
+		return {.step_hint	   = step_hint,
+				.previous	   = previous,
+				.last_output   = last_output,
+				.previous_step = previous_step,
+				.has_history   = has_history};
+	}
+	void set_resume(const IntegratorResume& resume)
+	{
+		step_hint	  = resume.step_hint;
+		previous	  = resume.previous;
+		last_output	  = resume.last_output;
+		previous_step = resume.previous_step;
+		has_history	  = resume.has_history;
+	}
+
+	// Продвигает env на duration секунд (для всех режимов, кроме EULER). false - неявная схема
+	// не сошлась или оценка ошибки RK45 не конечна и на минимальном подшаге (модель вне своей
+	// области), env не меняется
+	[[nodiscard]] bool advance(Environment& env, const ControllerGains& gains, double duration);
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Подсистемы пошаговой схемы (EULER) в порядке обновления внутри одного момента времени:
+// влажность и температура меняют массу и T, давление затем отвечает на них (PV=nRT)
+enum class Subsystem : std::uint8_t
+{
+	HUMIDITY,
+	TEMPERATURE,
+	PRESSURE,
+};
+
+constexpr std::size_t SUBSYSTEM_COUNT = 3;
+
+// Период каждой подсистемы в мс времени симуляции; 0 - один шаг на тик (на весь макрошаг)
+using SubsystemPeriods = std::array<unsigned long, SUBSYSTEM_COUNT>;
+
+// Многоскоростное расписание: быстрый контур давления шагает чаще, медленные тепловые
+// контуры - реже. Внутри макрошага (тика) время режется на отрезки до ближайшего срока любой
+// подсистемы; в каждый срок подсистема шагает на всё время, накопленное с её прошлого шага.
+// Подсистемы с периодом 0 шагают в конце макрошага, поэтому при всех периодах 0 получается
+// прежняя схема: H, T, P по одному разу на весь тик. Накопленное переносится между тиками
+class MultiRateScheduler
+{
+	SubsystemPeriods							periods{};
+	std::array<unsigned long, SUBSYSTEM_COUNT>	pending{}; // мс с прошлого шага подсистемы
+
+public:
+	[[nodiscard]] const SubsystemPeriods& get_periods() const
+	{
+		return periods;
+	}
+	void set_periods(const SubsystemPeriods& value)
+	{
+		periods = value;
+	}
+
+	// Для контрольных точек
+	[[nodiscard]] const std::array<unsigned long, SUBSYSTEM_COUNT>& get_pending() const
+	{
+		return pending;
+	}
+	void set_pending(const std::array<unsigned long, SUBSYSTEM_COUNT>& value)
+	{
+		pending = value;
+	}
+
+	// step(subsystem, seconds) вызывается для каждого шага подсистемы в порядке времени,
+	// в один момент - в порядке Subsystem
+	template <class Step> void advance(unsigned long milliseconds, Step&& step)
+	{
+		const double MILLIS_IN_SEC = 1000.0;
+
+		unsigned long remaining = milliseconds;
+		while (remaining > 0)
+		{
+			unsigned long slice = remaining;
+			for (std::size_t index = 0; index < SUBSYSTEM_COUNT; ++index)
+			{
+				if (periods[index] > 0)
+				{
+					slice = std::min(slice, periods[index] - std::min(pending[index], periods[index]));
+				}
+			}
+			slice = std::max(slice, 1UL);
+
+			remaining -= slice;
+			for (std::size_t index = 0; index < SUBSYSTEM_COUNT; ++index)
+			{
+				pending[index] += slice;
+				const bool due =
+					periods[index] > 0 ? pending[index] >= periods[index] : remaining == 0;
+				if (due)
+				{
+					step(static_cast<Subsystem>(index),
+						 static_cast<double>(pending[index]) / MILLIS_IN_SEC);
+					pending[index] = 0;
+				}
+			}
+		}
+	}
+};
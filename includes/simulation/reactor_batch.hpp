@@ -0,0 +1,134 @@
+#pragma once
+#include "../common/common.hpp"
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Парк реакторов в виде структуры массивов: каждое поле Environment хранится
+// отдельным непрерывным столбцом. Шаг по всему парку - это проход по столбцам,
+// который компилятор может векторизовать.
+class ReactorBatch
+{
+public:
+	// Временные столбцы для промежуточных величин шага (потери, тепло реакции и т.п.)
+	static constexpr std::size_t SCRATCH_COLUMNS = 2;
+
+private:
+	std::array<std::vector<double>, ENVIRONMENT_FIELD_COUNT> columns;
+	std::array<std::vector<double>, SCRATCH_COLUMNS>		 scratch_columns;
+	std::size_t												 count = 0;
+	ControllerGains											 gains;
+
+public:
+	ReactorBatch() = default;
+
+	explicit ReactorBatch(std::size_t capacity)
+	{
+		reserve(capacity);
+	}
+
+	void reserve(std::size_t capacity)
+	{
+		for (auto& column : columns)
+		{
+			column.reserve(capacity);
+		}
+		for (auto& column : scratch_columns)
+		{
+			column.reserve(capacity);
+		}
+	}
+
+	// Добавляет реактор и возвращает его индекс
+	std::size_t add(const Environment& env)
+	{
+		for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+		{
+			columns[field].push_back(env.*ENVIRONMENT_FIELDS[field].member);
+		}
+		for (auto& column : scratch_columns)
+		{
+			column.push_back(0.0);
+		}
+		return count++;
+	}
+
+	void clear()
+	{
+		for (auto& column : columns)
+		{
+			column.clear();
+		}
+		for (auto& column : scratch_columns)
+		{
+			column.clear();
+		}
+		count = 0;
+	}
+
+	[[nodiscard]] std::size_t size() const
+	{
+		return count;
+	}
+
+	[[nodiscard]] bool empty() const
+	{
+		return count == 0;
+	}
+
+	[[nodiscard]] std::span<double> column(EnvironmentField field)
+	{
+		return columns[static_cast<std::size_t>(field)];
+	}
+
+	[[nodiscard]] std::span<const double> column(EnvironmentField field) const
+	{
+		return columns[static_cast<std::size_t>(field)];
+	}
+
+	[[nodiscard]] double* data(EnvironmentField field)
+	{
+		return columns[static_cast<std::size_t>(field)].data();
+	}
+
+	[[nodiscard]] const double* data(EnvironmentField field) const
+	{
+		return columns[static_cast<std::size_t>(field)].data();
+	}
+
+	// Коэффициенты регуляторов общие для всего парка
+	[[nodiscard]] const ControllerGains& get_controller_gains() const
+	{
+		return gains;
+	}
+	void set_controller_gains(const ControllerGains& new_gains)
+	{
+		gains = new_gains;
+	}
+
+	[[nodiscard]] double* scratch(std::size_t slot)
+	{
+		return scratch_columns[slot].data();
+	}
+
+	// Собирает Environment одного реактора из столбцов
+	[[nodiscard]] Environment environment(std::size_t index) const
+	{
+		Environment env{};
+		for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+		{
+			env.*ENVIRONMENT_FIELDS[field].member = columns[field][index];
+		}
+		return env;
+	}
+
+	void set_environment(std::size_t index, const Environment& env)
+	{
+		for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+		{
+			columns[field][index] = env.*ENVIRONMENT_FIELDS[field].member;
+		}
+	}
+};
@@ -2,9 +2,15 @@
 #include "../backend/backend.hpp"
 #include "../common/common.hpp"
 #include "../config/config.hpp"
+#include "alarms.hpp"
+#include "integrator.hpp"
+#include "multirate.hpp"
 #include "thermodynamics.hpp"
 
+#include <functional>
 #include <memory>
+#include <utility>
+#include <vector>
 
 constexpr int TIME_OF_TICK = 100;
 
@@ -52,13 +58,83 @@ inline Environment make_environment(const AppConfig& cfg)
 
 const Environment ENV = make_environment(CFG); // NOLINT(cert-err58-cpp)
 
+// Вызывается в потоке симуляции в конце каждого тика с временем симуляции и новым состоянием
+using TickListener = std::function<void(unsigned long sim_time_millis, const Environment& env)>;
+
 class Simulation
 {
 private:
-	TemperatureController temp_controller;
-	PressureController	  pressure_controller;
-	HumidityController	  humidity_controller;
-	unsigned long		  current_time_millis = 0;
+	TemperatureController	  temp_controller;
+	PressureController		  pressure_controller;
+	HumidityController		  humidity_controller;
+	Integrator				  integrator;
+	MultiRateScheduler		  scheduler;
+	AlarmEngine				  alarms;
+	unsigned long			  current_time_millis = 0;
+	std::vector<TickListener> tick_listeners;
+	bool					  solver_alarm = false; // поднята тревога SOLVER_ALARM_RULE
+
+	// Датчики регуляторов: выход за их диапазон - критическая тревога
+	[[nodiscard]] std::vector<SensorRange> sensor_ranges()
+	{
+		Sensor temperature = temp_controller.get_sensor();
+		Sensor pressure	   = pressure_controller.get_sensor();
+		Sensor humidity	   = humidity_controller.get_sensor();
+		return {{"sensor.temperature", EnvironmentField::TEMPERATURE, temperature.get_min_value(),
+				 temperature.get_max_value()},
+				{"sensor.pressure", EnvironmentField::PRESSURE, pressure.get_min_value(),
+				 pressure.get_max_value()},
+				{"sensor.humidity", EnvironmentField::HUMIDITY, humidity.get_min_value(),
+				 humidity.get_max_value()}};
+	}
+
+	// Тревога SOLVER_ALARM_RULE: подъём при отменённом тике, снятие на следующем удачном
+	void record_solver_alarm(bool raised)
+	{
+		solver_alarm = raised;
+		state.get_alarm_log().record({.name			   = "integrator.convergence",
+									  .rule			   = SOLVER_ALARM_RULE,
+									  .severity		   = StatusMode::CRITICAL,
+									  .raised		   = raised,
+									  .value		   = state.get_environment().temperature,
+									  .sim_time_millis = current_time_millis});
+	}
+
+	// Неявная схема не сошлась: состояние реактора на конец тика неизвестно. Тик отменяется,
+	// прогон останавливается с критическим статусом
+	void fail_tick(unsigned long milliseconds)
+	{
+		current_time_millis -= milliseconds;
+		if (!solver_alarm)
+		{
+			record_solver_alarm(true);
+		}
+		state.set_status_mode(StatusMode::CRITICAL);
+		state.publish(current_time_millis);
+		state.set_running(false);
+	}
+
+	void finish_tick()
+	{
+		if (solver_alarm)
+		{
+			// Прогон снова запустили, и тик прошёл
+			record_solver_alarm(false);
+		}
+		{
+			const TraceScope span("Alarms");
+			state.set_status_mode(alarms.evaluate(current_time_millis, state.get_environment(),
+												  state.get_alarm_log()));
+		}
+		{
+			const TraceScope span("Snapshot");
+			state.publish(current_time_millis);
+		}
+		for (const auto& listener : tick_listeners)
+		{
+			listener(current_time_millis, state.get_environment());
+		}
+	}
 
 public:
 	State state; // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
@@ -69,6 +145,7 @@ public:
 		: temp_controller(MIN_TEMP, MAX_TEMP),
 		  pressure_controller(MIN_PRESSURE, MAX_PRESSURE),
 		  humidity_controller(MIN_HUMIDITY, MAX_HUMIDITY),
+		  alarms(AlarmRules::compile({}, sensor_ranges())),
 		  state(env, ControlMode::AUTOMATICLY, TemperatureController(MIN_TEMP, MAX_TEMP),
 				PressureController(MIN_PRESSURE, MAX_PRESSURE),
 				HumidityController(MIN_HUMIDITY, MAX_HUMIDITY))
@@ -77,6 +154,82 @@ public:
 
 	void operator()();
 
+	[[nodiscard]] unsigned long get_current_time_millis() const
+	{
+		return current_time_millis;
+	}
+	// Для восстановления из контрольной точки, до запуска потока симуляции
+	void set_current_time_millis(unsigned long millis)
+	{
+		current_time_millis = millis;
+		state.publish(current_time_millis);
+	}
+
+	[[nodiscard]] const Integrator& get_integrator() const
+	{
+		return integrator;
+	}
+	[[nodiscard]] Integrator& get_integrator()
+	{
+		return integrator;
+	}
+	void set_integrator_settings(const IntegratorSettings& settings)
+	{
+		integrator.set_settings(settings);
+	}
+
+	// Периоды подсистем пошаговой схемы (EULER); совместные интеграторы шагают всей системой
+	[[nodiscard]] const MultiRateScheduler& get_scheduler() const
+	{
+		return scheduler;
+	}
+	[[nodiscard]] MultiRateScheduler& get_scheduler()
+	{
+		return scheduler;
+	}
+	[[nodiscard]] const AlarmEngine& get_alarm_engine() const
+	{
+		return alarms;
+	}
+	[[nodiscard]] AlarmEngine& get_alarm_engine()
+	{
+		return alarms;
+	}
+	[[nodiscard]] bool has_solver_alarm() const
+	{
+		return solver_alarm;
+	}
+	// Для восстановления из контрольной точки, после set_current_time_millis: поднятая
+	// тревога снова попадает в журнал и снимается первым удачным тиком
+	void set_solver_alarm(bool raised)
+	{
+		if (raised)
+		{
+			record_solver_alarm(true);
+		}
+		else
+		{
+			solver_alarm = false;
+		}
+	}
+	// Правила из конфигурации плюс диапазоны датчиков. Бросает AlarmError
+	void set_alarm_rules(const std::vector<AlarmRuleConfig>& configs)
+	{
+		alarms.set_rules(AlarmRules::compile(configs, sensor_ranges()));
+	}
+
+	void set_subsystem_periods(const RatesConfig& rates)
+	{
+		scheduler.set_periods(
+			{rates.humidity_period_ms, rates.temperature_period_ms, rates.pressure_period_ms});
+	}
+
+	// Только до запуска потока симуляции
+	void add_tick_listener(TickListener listener)
+	{
+		tick_listeners.push_back(std::move(listener));
+	}
+
 	void simulate(unsigned long milliseconds)
 	{
 		if (!state.is_running())
@@ -93,21 +246,74 @@ public:
 			return;
 		}
 
-		// 1. Контроллер влажности меняет массу (добавляет воду) и температуру (испарение).
-		Thermodynamics::update_humidity_with_controller(state, d_t);
+		TickProfile&	   profile = state.get_profile();
+		const ProfileScope tick_scope(profile, ProfileStage::TICK);
+
+		if (integrator.get_settings().mode != IntegratorMode::EULER)
+		{
+			// T, P, влажность и масса интегрируются совместно, подшаги выбирает интегратор
+			Environment env		 = state.get_environment();
+			bool		advanced = false;
+			{
+				const ProfileScope scope(profile, ProfileStage::INTEGRATOR);
+				advanced = integrator.advance(env, state.get_controller_gains(), d_t);
+			}
+			if (!advanced)
+			{
+				fail_tick(milliseconds);
+				return;
+			}
+			state.set_environment(env);
+			const ProfileScope scope(profile, ProfileStage::PUBLISH);
+			finish_tick();
+			return;
+		}
 
-		// 2. Контроллер температуры компенсирует потери тепла
-		Thermodynamics::update_temperature_with_controller(state, d_t);
+		// Каждая подсистема шагает со своим периодом, см. MultiRateScheduler
+		scheduler.advance(milliseconds,
+						  [this, &profile](Subsystem subsystem, double step)
+						  {
+							  switch (subsystem)
+							  {
+								  // 1. Контроллер влажности меняет массу (добавляет воду) и
+								  // температуру (испарение).
+								  case Subsystem::HUMIDITY:
+								  {
+									  const ProfileScope scope(profile, ProfileStage::HUMIDITY);
+									  Thermodynamics::update_humidity_with_controller(state, step);
+									  break;
+								  }
+								  // 2. Контроллер температуры компенсирует потери тепла
+								  case Subsystem::TEMPERATURE:
+								  {
+									  const ProfileScope scope(profile, ProfileStage::TEMPERATURE);
+									  Thermodynamics::update_temperature_with_controller(state, step);
+									  break;
+								  }
+								  // 3. Контроллер давления реагирует на изменение общей массы и
+								  // температуры (PV=nRT).
+								  case Subsystem::PRESSURE:
+								  {
+									  const ProfileScope scope(profile, ProfileStage::PRESSURE);
+									  Thermodynamics::update_pressure_with_controller(state, step);
+									  break;
+								  }
+							  }
+						  });
 
-		// 3. Контроллер давления реагирует на изменение общей массы и температуры (PV=nRT).
-		Thermodynamics::update_pressure_with_controller(state, d_t);
+		const ProfileScope scope(profile, ProfileStage::PUBLISH);
+		finish_tick();
 	}
 
 	static std::shared_ptr<Simulation> shared_simulation()
 	{
-		return std::make_shared<Simulation>(ENV, CFG.reaction.min_temp, CFG.reaction.max_temp, 0,
-											CFG.reaction.max_pressure, 0,
-											CFG.reaction.max_humidity);
+		auto simulation = std::make_shared<Simulation>(ENV, CFG.reaction.min_temp,
+													   CFG.reaction.max_temp, 0,
+													   CFG.reaction.max_pressure, 0,
+													   CFG.reaction.max_humidity);
+		simulation->set_subsystem_periods(CFG.rates);
+		simulation->set_alarm_rules(CFG.alarms);
+		return simulation;
 	}
 };
 
@@ -0,0 +1,127 @@
+#pragma once
+#include "../common/common.hpp"
+#include "../config/config.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Потоковая выдача тиков для внешних программ: тик кладёт запись в ограниченную очередь,
+// отдельный поток-писатель забирает записи пачками и пишет их во все приёмники.
+// Тик не делает ввода-вывода; что он делает при полной очереди - решает StreamPolicy.
+
+struct StreamError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+struct StreamRecord
+{
+	unsigned long sim_time_millis;
+	Environment	  environment;
+};
+
+enum class StreamFormat : std::uint8_t
+{
+	CSV,	// заголовок time_ms и имена полей, как у --history
+	NDJSON, // объект JSON на строку
+	BINARY, // заголовок, затем записи фиксированной длины (см. BinaryStreamSink в stream.cpp)
+};
+
+// Приёмник записей; вызывается только из потока-писателя
+class StreamSink
+{
+public:
+	StreamSink()							 = default;
+	StreamSink(const StreamSink&)			 = delete;
+	StreamSink(StreamSink&&)				 = delete;
+	StreamSink& operator=(const StreamSink&) = delete;
+	StreamSink& operator=(StreamSink&&)		 = delete;
+	virtual ~StreamSink()					 = default;
+
+	// Бросает StreamError, если запись не удалась
+	virtual void write(std::span<const StreamRecord> records) = 0;
+	virtual void flush()									  = 0;
+};
+
+// "<формат>:<путь>", формат - csv, ndjson или binary; путь "-" - стандартный вывод
+struct StreamSpec
+{
+	StreamFormat format;
+	std::string	 path;
+
+	[[nodiscard]] bool is_stdout() const
+	{
+		return path == "-";
+	}
+};
+
+// Бросает std::invalid_argument для неизвестного формата или пустого пути
+[[nodiscard]] StreamSpec parse_stream_spec(std::string_view text);
+
+// Открывает (перезаписывает) файл приёмника. Бросает StreamError
+[[nodiscard]] std::unique_ptr<StreamSink> make_stream_sink(const StreamSpec& spec);
+
+class StreamWriter
+{
+public:
+	struct Stats
+	{
+		std::uint64_t written	= 0; // дошло до приёмников
+		std::uint64_t dropped	= 0; // выброшено из полной очереди (DROP_OLDEST) или после ошибки
+		std::uint64_t decimated = 0; // пропущено прореживанием (DECIMATE)
+	};
+
+private:
+	// Шаг прореживания не растёт дальше: одна запись из 1024
+	static constexpr std::uint32_t MAX_STRIDE = 1024;
+
+	std::vector<std::unique_ptr<StreamSink>> sinks;
+	StreamPolicy							 policy;
+
+	mutable std::mutex		  mutex;
+	std::condition_variable	  not_empty;
+	std::condition_variable	  not_full;
+	std::vector<StreamRecord> ring;
+	std::size_t				  head	  = 0;
+	std::size_t				  count	  = 0;
+	bool					  closing = false;
+	bool					  failed  = false;
+	std::exception_ptr		  error;
+	std::uint32_t			  stride = 1; // DECIMATE: пишется каждая stride-я запись
+	std::uint32_t			  phase	 = 0;
+	Stats					  stats;
+
+	std::thread worker;
+
+	void run();
+
+public:
+	// capacity - ёмкость очереди в записях. Запускает поток-писатель
+	StreamWriter(std::vector<std::unique_ptr<StreamSink>> sinks, std::size_t capacity,
+				 StreamPolicy policy);
+
+	StreamWriter(const StreamWriter&)			 = delete;
+	StreamWriter(StreamWriter&&)				 = delete;
+	StreamWriter& operator=(const StreamWriter&) = delete;
+	StreamWriter& operator=(StreamWriter&&)		 = delete;
+	~StreamWriter();
+
+	// Из потока симуляции. Ждёт только места в очереди и только при StreamPolicy::BLOCK
+	void push(unsigned long sim_time_millis, const Environment& env);
+
+	// Дописывает очередь, сбрасывает приёмники и останавливает писатель. Бросает ошибку
+	// приёмника, если она была. Повторный вызов ничего не делает
+	void close();
+
+	[[nodiscard]] Stats get_stats() const;
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "headless.hpp"
+#include "simulation.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Серия независимых прогонов по сетке параметров и/или случайным выборкам (Monte Carlo).
+// Каждый прогон - отдельная Simulation, собранная через make_environment из изменённого
+// AppConfig, прогоны распределяются по ThreadPool.
+
+// Предел точек на одну ось сетки: start:stop:1e12 не должен просить память под 1e12 чисел
+constexpr std::size_t MAX_SWEEP_AXIS_POINTS = 1'000'000;
+// Предел прогонов на всю серию (точки сетки * samples): под каждый прогон заводится строка
+constexpr std::size_t MAX_SWEEP_RUNS = 1'000'000;
+// Предел --threads: пул заводит столько потоков сразу, 1e9 упёрлось бы в лимиты системы
+constexpr std::size_t MAX_SWEEP_THREADS = 1024;
+
+enum class SweepDistribution : std::uint8_t
+{
+	GRID,	 // перебор values
+	UNIFORM, // равномерно на [first, second]
+	NORMAL	 // нормально, first - среднее, second - СКО
+};
+
+struct SweepAxis
+{
+	std::string			name; // например "reaction.needed_temp" или "gains.pressure_kp"
+	SweepDistribution	distribution = SweepDistribution::GRID;
+	std::vector<double> values;
+	double				first  = 0.0;
+	double				second = 0.0;
+};
+
+struct SweepOptions
+{
+	std::vector<SweepAxis> axes;
+	std::size_t			   samples = 1; // случайных выборок на каждую точку сетки
+	std::uint64_t		   seed	   = 0;
+	std::size_t			   threads = 0; // 0 - по числу аппаратных потоков
+	BatchOptions		   batch;
+};
+
+struct SweepRow
+{
+	std::size_t			run = 0;
+	std::vector<double> parameters; // в порядке SweepOptions::axes
+	Environment			final_state{};
+	StatusMode			status = StatusMode::NORMAL;
+	double				wall_seconds = 0.0;
+	std::string			error; // пусто, если прогон прошёл успешно
+};
+
+struct SweepTable
+{
+	std::vector<std::string> parameter_names;
+	std::vector<SweepRow>	 rows; // по порядку номеров прогонов, независимо от числа потоков
+	double					 wall_seconds = 0.0;
+	std::size_t				 threads	  = 0;
+
+	void write_csv(std::ostream& out) const;
+};
+
+// Разбор оси из командной строки:
+//   name=start:stop:count  - равномерная сетка из count точек
+//   name=v1,v2,v3          - явный список
+//   name=uniform:a:b       - равномерное распределение
+//   name=normal:mean:sd    - нормальное распределение
+// Бросает std::invalid_argument для неизвестного параметра, нечисел, count вне
+// [1, MAX_SWEEP_AXIS_POINTS], sd <= 0 или a > b
+[[nodiscard]] SweepAxis parse_sweep_axis(std::string_view spec);
+
+// Имена параметров, которые можно менять
+[[nodiscard]] std::vector<std::string_view> sweep_parameter_names();
+
+// Бросает std::invalid_argument, если прогонов больше MAX_SWEEP_RUNS
+[[nodiscard]] std::size_t sweep_run_count(const SweepOptions& options);
+
+// Ошибка параметра конкретного прогона (например, gains.temperature_band <= 0)
+// попадает в SweepRow::error, а не прерывает серию
+[[nodiscard]] SweepTable run_sweep(const AppConfig& base, const SweepOptions& options);
@@ -0,0 +1,142 @@
+#pragma once
+#include "../common/common.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Колоночный файл телеметрии: каждый тик, все поля Environment.
+//
+// Раскладка (порядок байт - как у машины, которая пишет):
+//   [0, TELEMETRY_DATA_OFFSET)    заголовок и имена полей
+//   блоки по TELEMETRY_BLOCK_SAMPLES отсчётов: колонка времени (uint64, мс),
+//   затем колонка каждого поля (double), все колонки одной длины
+//   индекс: для каждого блока время первого и последнего отсчёта
+//   хвост: число отсчётов, число блоков, смещение индекса, метка конца
+//
+// Писатель отображает файл в память и кладёт значения прямо в колонки, без буферов
+// и форматирования. Число отсчётов дублируется в заголовке после каждого тика, поэтому
+// файл, который не успели закрыть, всё равно читается (индекс строится по блокам).
+
+constexpr std::size_t TELEMETRY_BLOCK_SAMPLES = 4096;
+constexpr std::size_t TELEMETRY_DATA_OFFSET	  = 4096;
+constexpr std::size_t TELEMETRY_NAME_LENGTH	  = 32;
+
+struct TelemetryError : std::runtime_error
+{
+	using std::runtime_error::runtime_error;
+};
+
+// Ошибки роста файла (нет места, не отображается) не бросаются из append - он зовётся в потоке
+// симуляции: писатель переходит в состояние failed, дальше отсчёты только считаются в dropped,
+// а close() закрывает файл с теми, что успели записаться
+class TelemetryWriter
+{
+	int			  file		   = -1;
+	std::byte*	  mapping	   = nullptr;
+	std::size_t	  mapped_bytes = 0;
+	std::uint64_t samples	   = 0;
+	std::uint64_t dropped	   = 0;
+	bool		  failed	   = false;
+	std::string	  error;
+	std::string	  path;
+
+	// false и текст в error, если место не выделилось или не отобразилось; старое отображение
+	// при этом остаётся
+	bool remap(std::size_t bytes);
+
+public:
+	// Создаёт (перезаписывает) файл path
+	explicit TelemetryWriter(const std::string& path);
+
+	TelemetryWriter(const TelemetryWriter&)			   = delete;
+	TelemetryWriter(TelemetryWriter&&)				   = delete;
+	TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+	TelemetryWriter& operator=(TelemetryWriter&&)	   = delete;
+	~TelemetryWriter();
+
+	void append(unsigned long sim_time_millis, const Environment& env);
+
+	// Дописывает индекс и хвост, обрезает запас места. Повторный вызов ничего не делает
+	void close();
+
+	[[nodiscard]] std::uint64_t size() const
+	{
+		return samples;
+	}
+	[[nodiscard]] std::uint64_t get_dropped() const
+	{
+		return dropped;
+	}
+	// Почему писатель перестал писать; пусто, пока отсчёты не терялись
+	[[nodiscard]] const std::string& get_error() const
+	{
+		return error;
+	}
+};
+
+class TelemetryReader
+{
+public:
+	struct BlockIndex
+	{
+		std::uint64_t first_time;
+		std::uint64_t last_time;
+	};
+
+	// Отсчёты [begin, end) одного блока, колонки указывают прямо в отображение файла
+	struct Slice
+	{
+		std::span<const std::uint64_t>					   times;
+		std::array<const double*, ENVIRONMENT_FIELD_COUNT> columns{};
+
+		[[nodiscard]] std::span<const double> column(EnvironmentField field) const
+		{
+			return {columns[static_cast<std::size_t>(field)], times.size()};
+		}
+	};
+
+private:
+	int						 file		  = -1;
+	const std::byte*		 mapping	  = nullptr;
+	std::size_t				 mapped_bytes = 0;
+	std::uint64_t			 samples	  = 0;
+	std::vector<std::string> names;
+	std::vector<BlockIndex>	 index;
+
+	[[nodiscard]] const std::byte* block(std::size_t number) const;
+	void						   load_index(const std::string& path);
+
+public:
+	// Бросает TelemetryError, если файл не телеметрия или поля не совпадают с Environment
+	explicit TelemetryReader(const std::string& path);
+
+	TelemetryReader(const TelemetryReader&)			   = delete;
+	TelemetryReader(TelemetryReader&&)				   = delete;
+	TelemetryReader& operator=(const TelemetryReader&) = delete;
+	TelemetryReader& operator=(TelemetryReader&&)	   = delete;
+	~TelemetryReader();
+
+	[[nodiscard]] std::uint64_t size() const
+	{
+		return samples;
+	}
+
+	[[nodiscard]] const std::vector<std::string>& field_names() const
+	{
+		return names;
+	}
+
+	[[nodiscard]] const std::vector<BlockIndex>& blocks() const
+	{
+		return index;
+	}
+
+	// Отсчёты со временем from_millis <= t <= to_millis: по куску на каждый задетый блок.
+	// Блоки ищутся по индексу, внутри блока - двоичным поиском, данные не копируются
+	[[nodiscard]] std::vector<Slice> range(std::uint64_t from_millis, std::uint64_t to_millis) const;
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Векторные ядра для самых дорогих членов Thermodynamics по столбцам ReactorBatch.
+// Реализации: AVX-512 (8 реакторов за раз), AVX2+FMA (4 реактора) и скалярная,
+// выбор делается один раз во время выполнения по возможностям процессора.
+//
+// Скалярная версия считает через std::exp/std::pow и совпадает с Thermodynamics бит в бит.
+// Векторные версии используют собственные приближения exp/log:
+//  - exp: редукция по ln2 (Cody-Waite) + полином степени 13,
+//    относительная ошибка <= EXP_MAX_RELATIVE_ERROR для x из [-708, 709];
+//    ниже -708 результат 0, выше 709 - бесконечность;
+//  - pow(x, y) = exp(y * log(x)) для x > 0 (x == 0 даёт 0),
+//    относительная ошибка <= POW_MAX_RELATIVE_ERROR + POW_RELATIVE_ERROR_PER_UNIT * |y * ln(x)|.
+//    Денормализованные x не поддерживаются. В Dittus-Boelter Re^a * Pr^b считается одной
+//    экспонентой, там y * ln(x) заменяется на a * ln(Re) + b * ln(Pr).
+namespace kernels
+{
+	constexpr double EXP_MAX_RELATIVE_ERROR		 = 4e-16;
+	constexpr double POW_MAX_RELATIVE_ERROR		 = 4e-16;
+	constexpr double POW_RELATIVE_ERROR_PER_UNIT = 3e-16;
+
+	enum class Isa : std::uint8_t
+	{
+		SCALAR,
+		AVX2,
+		AVX512
+	};
+
+	[[nodiscard]] std::string_view isa_name(Isa isa);
+
+	// Лучший набор инструкций, поддерживаемый процессором
+	[[nodiscard]] Isa detected_isa();
+
+	// Набор инструкций, который используют ядра сейчас
+	[[nodiscard]] Isa active_isa();
+
+	// Принудительный выбор (для сравнения и бенчмарков). false, если процессор не поддерживает.
+	bool set_isa(Isa isa);
+
+	// conduction + convection + radiation
+	struct HeatLossInputs
+	{
+		const double* temperature;
+		const double* ambient_temperature;
+		const double* surface_area;
+		const double* wall_thickness;
+		const double* wall_thermal_conductivity;
+		const double* heat_transfer_coefficient;
+	};
+
+	struct RadiationParams
+	{
+		double stefan_boltzmann;
+		double emissivity;
+	};
+
+	// k0 * exp(-Ea / (R * T)) * m * Q, 0 при T <= 0
+	struct ArrheniusParams
+	{
+		double rate_constant;
+		double activation_energy;
+		double gas_constant;
+		double heat_of_reaction;
+	};
+
+	// Nu = C * Re^a * Pr^b, h = Nu * k / L
+	struct DittusBoelterParams
+	{
+		double coefficient;
+		double reynolds_exponent;
+		double prandtl_exponent;
+		double characteristic_length;
+		double flow_velocity;
+		double viscosity;
+	};
+
+	void total_heat_loss(const HeatLossInputs& inputs, const RadiationParams& params, double* out,
+						 std::size_t count);
+
+	void arrhenius_heat_rate(const double* temperature, const double* mass,
+							 const ArrheniusParams& params, double* out, std::size_t count);
+
+	void dittus_boelter(const double* thermal_conductivity, const double* mass, const double* volume,
+						const double* heat_capacity, const DittusBoelterParams& params, double* out,
+						std::size_t count);
+} // namespace kernels
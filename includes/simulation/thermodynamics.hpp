@@ -1,57 +1,75 @@
 #pragma once
 #include "../common/common.hpp"
+#include "reactor_batch.hpp"
+#include "thermo_kernels.hpp"
+#include "../common/thermo_tables.hpp"
 #include <algorithm>
 #include <cmath>
+#include <memory>
 
-class Thermodynamics {
+// Физика реактора для модели Model (см. physics_model.hpp): все константы - constexpr модели,
+// поэтому каждая химия получает свои полностью встроенные функции.
+template<PhysicsModel Model>
+class BasicThermodynamics {
 private:
-    static constexpr double STEFAN_BOLTZMANN = 5.670374419e-8;
-    static constexpr double GAS_CONSTANT = 8.314462618;
-    static constexpr double DEFAULT_EMISSIVITY = 0.1;
-    static constexpr double WATER_FRACTION_DEFAULT = 0.7;
-    static constexpr double ORGANIC_FRACTION_DEFAULT = 0.3;
-    static constexpr double REACTION_RATE_CONSTANT_DEFAULT = 1e-3;
-    static constexpr double ACTIVATION_ENERGY_DEFAULT = 50000.0;
-    static constexpr double HEAT_OF_REACTION_DEFAULT = 100000.0;
-    static constexpr double VISCOSITY_DEFAULT = 1e-3;
-    static constexpr double CHARACTERISTIC_LENGTH = 0.1;
-    static constexpr double DITTUS_BOELTER_COEFFICIENT = 0.023;
-    static constexpr double REYNOLDS_EXPONENT = 0.8;
-    static constexpr double PRANDTL_EXPONENT = 0.4;
-    static constexpr double MOLAR_MASS_WATER = 0.018015;
-    static constexpr double LATENT_HEAT_WATER = 2260000.0;
+    static constexpr double STEFAN_BOLTZMANN = Model::STEFAN_BOLTZMANN;
+    static constexpr double GAS_CONSTANT = Model::GAS_CONSTANT;
+    static constexpr double DEFAULT_EMISSIVITY = Model::EMISSIVITY;
+    static constexpr double WATER_FRACTION_DEFAULT = Model::WATER_FRACTION;
+    static constexpr double ORGANIC_FRACTION_DEFAULT = Model::ORGANIC_FRACTION;
+    static constexpr double REACTION_RATE_CONSTANT_DEFAULT = Model::REACTION_RATE_CONSTANT;
+    static constexpr double ACTIVATION_ENERGY_DEFAULT = Model::ACTIVATION_ENERGY;
+    static constexpr double HEAT_OF_REACTION_DEFAULT = Model::HEAT_OF_REACTION;
+    static constexpr double VISCOSITY_DEFAULT = Model::VISCOSITY;
+    static constexpr double CHARACTERISTIC_LENGTH = Model::CHARACTERISTIC_LENGTH;
+    static constexpr double DITTUS_BOELTER_COEFFICIENT = Model::DITTUS_BOELTER_COEFFICIENT;
+    static constexpr double REYNOLDS_EXPONENT = Model::REYNOLDS_EXPONENT;
+    static constexpr double PRANDTL_EXPONENT = Model::PRANDTL_EXPONENT;
+    static constexpr double MOLAR_MASS_WATER = Model::MOLAR_MASS_WATER;
+    static constexpr double LATENT_HEAT_WATER = Model::LATENT_HEAT_WATER;
+    static constexpr double ANTOINE_A = Model::ANTOINE_A;
+    static constexpr double ANTOINE_B = Model::ANTOINE_B;
+    static constexpr double ANTOINE_C = Model::ANTOINE_C;
+    static constexpr double ANTOINE_MIN_CELSIUS = Model::ANTOINE_MIN_CELSIUS;
+    static constexpr double PASCAL_PER_MMHG = Model::PASCAL_PER_MMHG;
+    static constexpr double MIN_SATURATION_PRESSURE = Model::MIN_SATURATION_PRESSURE;
     
 public:
-    static double calculate_conduction_heat_loss(const State& state) {
-        double thermal_conductivity = state.get_wall_thermal_conductivity();
-        double surface_area = state.get_surface_area();
-        double wall_thickness = state.get_wall_thickness();
-        double temperature_internal = state.get_temperature();
-        double temperature_ambient = state.get_ambient_temperature();
-        
+    // Перегрузки от чисел используются и для State, и для ReactorBatch (по столбцам).
+    static double calculate_conduction_heat_loss(double thermal_conductivity, double surface_area, double wall_thickness,
+                                                 double temperature_internal, double temperature_ambient) {
         if (wall_thickness <= 0.0) {
             return 0.0;
         }
         
         return thermal_conductivity * surface_area * (temperature_internal - temperature_ambient) / wall_thickness;
     }
+
+    static double calculate_conduction_heat_loss(const State& state) {
+        return calculate_conduction_heat_loss(state.get_wall_thermal_conductivity(), state.get_surface_area(),
+                                              state.get_wall_thickness(), state.get_temperature(),
+                                              state.get_ambient_temperature());
+    }
     
-    static double calculate_convection_heat_loss(const State& state) {
-        double heat_transfer_coefficient = state.get_heat_transfer_coefficient();
-        double surface_area = state.get_surface_area();
-        double temperature_surface = state.get_temperature();
-        double temperature_ambient = state.get_ambient_temperature();
-        
+    static double calculate_convection_heat_loss(double heat_transfer_coefficient, double surface_area,
+                                                 double temperature_surface, double temperature_ambient) {
         return heat_transfer_coefficient * surface_area * (temperature_surface - temperature_ambient);
     }
+
+    static double calculate_convection_heat_loss(const State& state) {
+        return calculate_convection_heat_loss(state.get_heat_transfer_coefficient(), state.get_surface_area(),
+                                              state.get_temperature(), state.get_ambient_temperature());
+    }
     
-    static double calculate_radiation_heat_loss(const State& state, double emissivity = DEFAULT_EMISSIVITY) {
-        double surface_area = state.get_surface_area();
-        double temperature = state.get_temperature();
-        double temperature_ambient = state.get_ambient_temperature();
-        
+    static double calculate_radiation_heat_loss(double surface_area, double temperature, double temperature_ambient,
+                                                double emissivity = DEFAULT_EMISSIVITY) {
         return STEFAN_BOLTZMANN * emissivity * surface_area * (std::pow(temperature, 4) - std::pow(temperature_ambient, 4));
     }
+
+    static double calculate_radiation_heat_loss(const State& state, double emissivity = DEFAULT_EMISSIVITY) {
+        return calculate_radiation_heat_loss(state.get_surface_area(), state.get_temperature(),
+                                             state.get_ambient_temperature(), emissivity);
+    }
     
     static double calculate_total_heat_loss(const State& state) {
         return calculate_conduction_heat_loss(state) + 
@@ -59,6 +77,17 @@ public:
                calculate_radiation_heat_loss(state);
     }
     
+    static double calculate_temperature_change(double mass, double heat_capacity, double heat_input,
+                                               double heat_loss, double delta_time) {
+        if (mass <= 0.0 || heat_capacity <= 0.0) {
+            return 0.0;
+        }
+        
+        double net_heat_flow = heat_input - heat_loss;
+        
+        return (net_heat_flow * delta_time) / (mass * heat_capacity);
+    }
+
     static double calculate_temperature_change(const State& state, double delta_time) {
         double mass = state.get_mass();
         double heat_capacity = state.get_heat_capacity();
@@ -71,63 +100,173 @@ public:
         
         double heat_loss = calculate_total_heat_loss(state) + state.get_cooling_rate();
         
-        double net_heat_flow = heat_input - heat_loss;
-        
-        return (net_heat_flow * delta_time) / (mass * heat_capacity);
+        return calculate_temperature_change(mass, heat_capacity, heat_input, heat_loss, delta_time);
     }
     
     static double calculate_mixture_heat_capacity(double water_fraction = WATER_FRACTION_DEFAULT, 
                                                   double organic_fraction = ORGANIC_FRACTION_DEFAULT) {
-        const double WATER_CP = 4180.0;
-        const double ORGANIC_CP = 2000.0;
-        
-        return (water_fraction * WATER_CP) + (organic_fraction * ORGANIC_CP);
+        return Model::mixture_heat_capacity(water_fraction, organic_fraction);
     }
     
-    static double calculate_reaction_heat_rate(const State& state, 
+    static double calculate_reaction_heat_rate(double temperature, double mass,
                                                double reaction_rate_constant = REACTION_RATE_CONSTANT_DEFAULT,
                                                double activation_energy = ACTIVATION_ENERGY_DEFAULT) {
-        double temperature = state.get_temperature();
-
         if (temperature <= 0.0) {
             return 0.0;
         }
         
-        double rate_constant = reaction_rate_constant * std::exp(-activation_energy / (GAS_CONSTANT * temperature));
+        double rate_constant =
+            reaction_rate_constant * ThermoTables<Model>::arrhenius_factor(activation_energy, GAS_CONSTANT, temperature);
         
         double heat_of_reaction = HEAT_OF_REACTION_DEFAULT;
-        return rate_constant * state.get_mass() * heat_of_reaction;
+        return rate_constant * mass * heat_of_reaction;
+    }
+
+    static double calculate_reaction_heat_rate(const State& state, 
+                                               double reaction_rate_constant = REACTION_RATE_CONSTANT_DEFAULT,
+                                               double activation_energy = ACTIVATION_ENERGY_DEFAULT) {
+        return calculate_reaction_heat_rate(state.get_temperature(), state.get_mass(), reaction_rate_constant,
+                                            activation_energy);
     }
     
-    static double calculate_heat_transfer_coefficient(const State& state, 
-                                                      double flow_velocity = 1.0,
+    static double calculate_heat_transfer_coefficient(double thermal_conductivity, double mass, double volume,
+                                                      double heat_capacity, double flow_velocity = 1.0,
                                                       double viscosity = VISCOSITY_DEFAULT) {
-        double thermal_conductivity = state.get_thermal_conductivity();
-        double density = state.get_mass() / state.get_volume();
+        double density = mass / volume;
         
         double reynolds_number = density * flow_velocity * CHARACTERISTIC_LENGTH / viscosity;
         
-        double prandtl_number = viscosity * state.get_heat_capacity() / thermal_conductivity;
+        double prandtl_number = viscosity * heat_capacity / thermal_conductivity;
         
         double nusselt_number = DITTUS_BOELTER_COEFFICIENT * std::pow(reynolds_number, REYNOLDS_EXPONENT) * std::pow(prandtl_number, PRANDTL_EXPONENT);
         
         return nusselt_number * thermal_conductivity / CHARACTERISTIC_LENGTH;
     }
 
+    static double calculate_heat_transfer_coefficient(const State& state, 
+                                                      double flow_velocity = 1.0,
+                                                      double viscosity = VISCOSITY_DEFAULT) {
+        return calculate_heat_transfer_coefficient(state.get_thermal_conductivity(), state.get_mass(),
+                                                   state.get_volume(), state.get_heat_capacity(), flow_velocity,
+                                                   viscosity);
+    }
+
+    // Тепло фазового перехода: испарение (water_mass_flow > 0) охлаждает, конденсация нагревает
+    static double calculate_latent_heat_rate(double water_mass_flow) {
+        return -water_mass_flow * LATENT_HEAT_WATER;
+    }
+
+    // По таблице, если она построена и покрывает температуру, иначе - точная формула
     static double calculate_saturation_pressure(double temperature_kelvin) {
-        // Константы для воды (диапазон 1C - 374C)
-        // log10(P_mmHg) = A - B / (C + T_celsius)
-        const double A = 8.07131;
-        const double B = 1730.63;
-        const double C = 233.426;
+        const ThermoTables<Model>* tables = ThermoTables<Model>::active();
+        if (tables != nullptr && tables->saturation_pressure.covers(temperature_kelvin)) {
+            return tables->saturation_pressure(temperature_kelvin);
+        }
+
+        return calculate_saturation_pressure_exact(temperature_kelvin);
+    }
 
+    static double calculate_saturation_pressure_exact(double temperature_kelvin) {
         double temp_c = temperature_kelvin - 273.15;
-        temp_c = std::max(temp_c, 1.0); // защита границ
+        temp_c = std::max(temp_c, ANTOINE_MIN_CELSIUS); // защита границ
 
-        double p_mmHg = std::pow(10, A - (B / (C + temp_c)));
-        double p_pascal = p_mmHg * 133.322; // конвертация в Паскали
+        double p_mmHg = std::pow(10, ANTOINE_A - (ANTOINE_B / (ANTOINE_C + temp_c)));
+        double p_pascal = p_mmHg * PASCAL_PER_MMHG; // конвертация в Паскали
         return p_pascal;
     }
+
+    // ===Производные членов по состоянию (аналитический якобиан для неявных схем)===
+
+    // d(conduction)/dT
+    static double calculate_conduction_heat_loss_derivative(double thermal_conductivity, double surface_area,
+                                                            double wall_thickness) {
+        if (wall_thickness <= 0.0) {
+            return 0.0;
+        }
+
+        return thermal_conductivity * surface_area / wall_thickness;
+    }
+
+    // d(convection)/dT
+    static double calculate_convection_heat_loss_derivative(double heat_transfer_coefficient, double surface_area) {
+        return heat_transfer_coefficient * surface_area;
+    }
+
+    // d(radiation)/dT
+    static double calculate_radiation_heat_loss_derivative(double surface_area, double temperature,
+                                                           double emissivity = DEFAULT_EMISSIVITY) {
+        return 4.0 * STEFAN_BOLTZMANN * emissivity * surface_area * std::pow(temperature, 3);
+    }
+
+    // d(reaction heat)/dT; по массе тепло реакции линейно: d/dm = rate / mass
+    static double calculate_reaction_heat_rate_derivative(double temperature, double mass,
+                                                          double reaction_rate_constant = REACTION_RATE_CONSTANT_DEFAULT,
+                                                          double activation_energy = ACTIVATION_ENERGY_DEFAULT) {
+        if (temperature <= 0.0) {
+            return 0.0;
+        }
+
+        double rate = calculate_reaction_heat_rate(temperature, mass, reaction_rate_constant, activation_energy);
+        return rate * activation_energy / (GAS_CONSTANT * temperature * temperature);
+    }
+
+    // d(htc)/dm: Re пропорционально плотности, htc ~ m^REYNOLDS_EXPONENT
+    static double calculate_heat_transfer_coefficient_mass_derivative(double heat_transfer_coefficient,
+                                                                      double mass) {
+        if (mass <= 0.0) {
+            return 0.0;
+        }
+
+        return REYNOLDS_EXPONENT * heat_transfer_coefficient / mass;
+    }
+
+    static double calculate_saturation_pressure_derivative(double temperature_kelvin) {
+        double temp_c = temperature_kelvin - 273.15;
+        if (temp_c < ANTOINE_MIN_CELSIUS) {
+            return 0.0; // на защитной границе давление постоянно
+        }
+
+        double denominator = ANTOINE_C + temp_c;
+        return calculate_saturation_pressure(temperature_kelvin) * std::log(10.0) * ANTOINE_B /
+               (denominator * denominator);
+    }
+
+    // Таблицы для calculate_saturation_pressure и множителя Аррениуса на [min_temperature, max_temperature].
+    // Давление насыщения - только выше защитной границы Антуана: на изломе полином не сходится
+    static std::unique_ptr<ThermoTables<Model>> build_tables(const ThermoTableSettings& settings) {
+        auto tables = std::make_unique<ThermoTables<Model>>();
+
+        const double saturation_lower = std::max(settings.min_temperature, 273.15 + ANTOINE_MIN_CELSIUS);
+        tables->saturation_pressure = HermiteTable::build(
+            [](double t) { return calculate_saturation_pressure_exact(t); },
+            [](double t) {
+                double denominator = ANTOINE_C + (t - 273.15);
+                return calculate_saturation_pressure_exact(t) * std::log(10.0) * ANTOINE_B /
+                       (denominator * denominator);
+            },
+            saturation_lower, settings.max_temperature, settings.relative_error);
+
+        const double ratio = ACTIVATION_ENERGY_DEFAULT / GAS_CONSTANT;
+        const double arrhenius_lower = std::max(settings.min_temperature, 1.0);
+        tables->arrhenius_ratio = ratio;
+        tables->arrhenius = HermiteTable::build(
+            [](double t) { return std::exp(-ACTIVATION_ENERGY_DEFAULT / (GAS_CONSTANT * t)); },
+            [ratio](double t) { return std::exp(-ACTIVATION_ENERGY_DEFAULT / (GAS_CONSTANT * t)) * ratio / (t * t); },
+            arrhenius_lower, settings.max_temperature, settings.relative_error);
+
+        return tables;
+    }
+
+    static double calculate_max_water_vapor_mass_derivative(double temp, double vol) {
+        double p_sat = calculate_saturation_pressure(temp);
+        if (p_sat <= MIN_SATURATION_PRESSURE) {
+            return -calculate_max_water_vapor_mass(temp, vol) / temp;
+        }
+
+        // m_max ~ P_sat(T) / T
+        double p_sat_derivative = calculate_saturation_pressure_derivative(temp);
+        return calculate_max_water_vapor_mass(temp, vol) * ((p_sat_derivative / p_sat) - (1.0 / temp));
+    }
     
     static void update_temperature(State& state, double delta_time) {
         state.set_heat_capacity(calculate_mixture_heat_capacity());
@@ -145,7 +284,9 @@ public:
         state.set_reaction_heat_rate(calculate_reaction_heat_rate(state));
         state.set_heat_transfer_coefficient(calculate_heat_transfer_coefficient(state));
         
-        auto [heating_power, cooling_power] = TemperatureController::calculate_parallel_control_output<State>(state);
+        TemperatureController& controller = state.get_temperature_controller();
+        auto [heating_power, cooling_power] = controller.calculate_parallel_control_output<Model>(
+            state, state.get_controller_gains().temperature_band);
         
         state.set_heating_rate(heating_power);
         state.set_cooling_rate(cooling_power);
@@ -156,23 +297,25 @@ public:
         state.set_temperature(new_temperature);
     }
 
-    static double calculate_pressure(const State& state) {
-        double gas_const = state.get_specific_gas_constant();
-        double volume = state.get_volume();
-        double temp = state.get_temperature();
-        double mass = state.get_mass();
-
+    static double calculate_pressure(double gas_const, double volume, double temp, double mass,
+                                     double current_pressure) {
         if (gas_const <= 0.0 || volume <= 0.0 || temp <= 0.0) {
-            return state.get_pressure(); // не меняем
+            return current_pressure; // не меняем
         }
 
         return (mass * gas_const * temp) / volume;
     }
 
+    static double calculate_pressure(const State& state) {
+        return calculate_pressure(state.get_specific_gas_constant(), state.get_volume(), state.get_temperature(),
+                                  state.get_mass(), state.get_pressure());
+    }
+
     // Обновляет массу/давление, руководствуясь регулятором давления.
     static void update_pressure_with_controller(State& state, double delta_time) {
         // Рассчитать изменение массы, которое предложит контроллер
-        double mass_delta = PressureController::calculate_mass_flow_output<State>(state, delta_time);
+        double mass_delta = PressureController::calculate_mass_flow_output<State>(
+            state, delta_time, state.get_controller_gains().pressure_kp);
 
         // Применяем изменение массы
         double new_mass = state.get_mass() + mass_delta;
@@ -184,19 +327,20 @@ public:
         state.set_pressure(new_pressure);
     }
 
-    static void update_humidity_with_controller(State& state, double delta_time) {
-        double temp = state.get_temperature();
-        double vol = state.get_volume();
-        
+    static double calculate_max_water_vapor_mass(double temp, double vol) {
         // Рассчитываем давление насыщенного пара (P_sat) при текущей T
         double p_sat = calculate_saturation_pressure(temp);
         
         // Защита от физически некорректных значений при очень низких температурах
-        p_sat = std::max(p_sat, 0.1); 
+        p_sat = std::max(p_sat, MIN_SATURATION_PRESSURE);
 
         // Рассчитываем МАКСИМАЛЬНУЮ массу воды (газообразной), которую может вместить реактор
         // m_max = (P_sat * V * M) / (R * T)
-        double max_water_vapor_mass = (p_sat * vol * MOLAR_MASS_WATER) / (GAS_CONSTANT * temp);
+        return (p_sat * vol * MOLAR_MASS_WATER) / (GAS_CONSTANT * temp);
+    }
+
+    static void update_humidity_with_controller(State& state, double delta_time) {
+        double max_water_vapor_mass = calculate_max_water_vapor_mass(state.get_temperature(), state.get_volume());
 
         // Получаем текущую массу воды на основе текущей влажности
         // Humidity = (m_current / m_max) * 100 => m_current = (Humidity / 100) * m_max
@@ -204,7 +348,8 @@ public:
 
         // Спрашиваем контроллер, сколько воды добавить/убрать
         // Но теперь передаем ему max_mass, чтобы он понимал масштаб
-        double water_flow_rate = HumidityController::calculate_water_injection_rate<State>(state, delta_time, max_water_vapor_mass);
+        double water_flow_rate = HumidityController::calculate_water_injection_rate<State>(
+            state, delta_time, max_water_vapor_mass, state.get_controller_gains().humidity_kp);
         
         double mass_change = water_flow_rate * delta_time;
 
@@ -238,4 +383,149 @@ public:
         // Сглаживание температурного скачка (чтобы не было взрыва значений)
         state.set_temperature(state.get_temperature() + temp_correction);
     }
-};
\ No newline at end of file
+
+    // ===Пакетные версии: один проход по столбцам всего парка ReactorBatch===
+
+    static void update_humidity_with_controller(ReactorBatch& batch, double delta_time) {
+        const std::size_t count = batch.size();
+        double* mass = batch.data(EnvironmentField::MASS);
+        double* temperature = batch.data(EnvironmentField::TEMPERATURE);
+        double* humidity = batch.data(EnvironmentField::HUMIDITY);
+        const double* volume = batch.data(EnvironmentField::VOLUME);
+        const double* needed_humidity = batch.data(EnvironmentField::NEEDED_HUMIDITY);
+        const double* heat_capacity = batch.data(EnvironmentField::HEAT_CAPACITY);
+        const double humidity_kp = batch.get_controller_gains().humidity_kp;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            double max_water_vapor_mass = calculate_max_water_vapor_mass(temperature[i], volume[i]);
+            double current_water_mass = (humidity[i] / 100.0) * max_water_vapor_mass;
+            double water_flow_rate = HumidityController::calculate_water_injection_rate(
+                humidity[i], needed_humidity[i], delta_time, max_water_vapor_mass, humidity_kp);
+
+            double new_water_mass = current_water_mass + (water_flow_rate * delta_time);
+            new_water_mass = std::max(new_water_mass, 0.0);
+            new_water_mass = std::min(new_water_mass, max_water_vapor_mass);
+
+            double real_mass_delta = new_water_mass - current_water_mass;
+            mass[i] = mass[i] + real_mass_delta;
+            humidity[i] = (new_water_mass / max_water_vapor_mass) * 100.0;
+
+            double energy_change = -real_mass_delta * LATENT_HEAT_WATER;
+            temperature[i] = temperature[i] + (energy_change / (mass[i] * heat_capacity[i]));
+        }
+    }
+
+    static void update_temperature_with_controller(ReactorBatch& batch, double delta_time) {
+        const std::size_t count = batch.size();
+        const double* mass = batch.data(EnvironmentField::MASS);
+        const double* volume = batch.data(EnvironmentField::VOLUME);
+        double* temperature = batch.data(EnvironmentField::TEMPERATURE);
+        const double* needed_temperature = batch.data(EnvironmentField::NEEDED_TEMPERATURE);
+        const double* max_energy_consumption = batch.data(EnvironmentField::MAX_ENERGY_CONSUMPTION);
+        double* heat_capacity = batch.data(EnvironmentField::HEAT_CAPACITY);
+        const double* thermal_conductivity = batch.data(EnvironmentField::THERMAL_CONDUCTIVITY);
+        const double* surface_area = batch.data(EnvironmentField::SURFACE_AREA);
+        const double* wall_thickness = batch.data(EnvironmentField::WALL_THICKNESS);
+        const double* wall_thermal_conductivity = batch.data(EnvironmentField::WALL_THERMAL_CONDUCTIVITY);
+        const double* ambient_temperature = batch.data(EnvironmentField::AMBIENT_TEMPERATURE);
+        double* heat_transfer_coefficient = batch.data(EnvironmentField::HEAT_TRANSFER_COEFFICIENT);
+        double* reaction_heat_rate = batch.data(EnvironmentField::REACTION_HEAT_RATE);
+        double* cooling_rate = batch.data(EnvironmentField::COOLING_RATE);
+        double* heating_rate = batch.data(EnvironmentField::HEATING_RATE);
+
+        const double temperature_band = batch.get_controller_gains().temperature_band;
+        double* loss = batch.scratch(0);
+        double* reaction = batch.scratch(1);
+
+        const kernels::RadiationParams radiation{.stefan_boltzmann = STEFAN_BOLTZMANN,
+                                                 .emissivity = DEFAULT_EMISSIVITY};
+        const kernels::ArrheniusParams arrhenius{.rate_constant = REACTION_RATE_CONSTANT_DEFAULT,
+                                                 .activation_energy = ACTIVATION_ENERGY_DEFAULT,
+                                                 .gas_constant = GAS_CONSTANT,
+                                                 .heat_of_reaction = HEAT_OF_REACTION_DEFAULT};
+        const kernels::DittusBoelterParams dittus_boelter{.coefficient = DITTUS_BOELTER_COEFFICIENT,
+                                                          .reynolds_exponent = REYNOLDS_EXPONENT,
+                                                          .prandtl_exponent = PRANDTL_EXPONENT,
+                                                          .characteristic_length = CHARACTERISTIC_LENGTH,
+                                                          .flow_velocity = 1.0,
+                                                          .viscosity = VISCOSITY_DEFAULT};
+
+        const double mixture_heat_capacity = calculate_mixture_heat_capacity();
+        for (std::size_t i = 0; i < count; ++i) {
+            heat_capacity[i] = mixture_heat_capacity;
+        }
+
+        kernels::arrhenius_heat_rate(temperature, mass, arrhenius, reaction_heat_rate, count);
+        kernels::dittus_boelter(thermal_conductivity, mass, volume, heat_capacity, dittus_boelter,
+                                heat_transfer_coefficient, count);
+
+        // Регулятор: компенсация потерь при нужной температуре + пропорциональная часть
+        kernels::total_heat_loss({.temperature = needed_temperature,
+                                  .ambient_temperature = ambient_temperature,
+                                  .surface_area = surface_area,
+                                  .wall_thickness = wall_thickness,
+                                  .wall_thermal_conductivity = wall_thermal_conductivity,
+                                  .heat_transfer_coefficient = heat_transfer_coefficient},
+                                 radiation, loss, count);
+        kernels::arrhenius_heat_rate(needed_temperature, mass, arrhenius, reaction, count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            auto [heating_power, cooling_power] = TemperatureController::calculate_parallel_control_output(
+                needed_temperature[i] - temperature[i], loss[i], reaction[i], max_energy_consumption[i],
+                temperature_band);
+            heating_rate[i] = heating_power;
+            cooling_rate[i] = cooling_power;
+        }
+
+        kernels::total_heat_loss({.temperature = temperature,
+                                  .ambient_temperature = ambient_temperature,
+                                  .surface_area = surface_area,
+                                  .wall_thickness = wall_thickness,
+                                  .wall_thermal_conductivity = wall_thermal_conductivity,
+                                  .heat_transfer_coefficient = heat_transfer_coefficient},
+                                 radiation, loss, count);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            double heat_input = heating_rate[i] + reaction_heat_rate[i];
+            double heat_loss = loss[i] + cooling_rate[i];
+
+            temperature[i] = temperature[i] + calculate_temperature_change(mass[i], heat_capacity[i], heat_input,
+                                                                           heat_loss, delta_time);
+        }
+    }
+
+    static void update_pressure_with_controller(ReactorBatch& batch, double delta_time) {
+        const std::size_t count = batch.size();
+        double* mass = batch.data(EnvironmentField::MASS);
+        double* pressure = batch.data(EnvironmentField::PRESSURE);
+        const double* volume = batch.data(EnvironmentField::VOLUME);
+        const double* temperature = batch.data(EnvironmentField::TEMPERATURE);
+        const double* needed_pressure = batch.data(EnvironmentField::NEEDED_PRESSURE);
+        const double* specific_gas_constant = batch.data(EnvironmentField::SPECIFIC_GAS_CONSTANT);
+        const double pressure_kp = batch.get_controller_gains().pressure_kp;
+
+        for (std::size_t i = 0; i < count; ++i) {
+            double mass_delta = PressureController::calculate_mass_flow_output(
+                specific_gas_constant[i], volume[i], temperature[i], pressure[i], needed_pressure[i], mass[i],
+                delta_time, pressure_kp);
+
+            double new_mass = std::max(mass[i] + mass_delta, 1e-6);
+            mass[i] = new_mass;
+            pressure[i] = calculate_pressure(specific_gas_constant[i], volume[i], temperature[i], new_mass,
+                                             pressure[i]);
+        }
+    }
+
+    // Тот же порядок, что и в Simulation::simulate
+    static void step(ReactorBatch& batch, double delta_time) {
+        if (delta_time <= 0.0) {
+            return;
+        }
+
+        update_humidity_with_controller(batch, delta_time);
+        update_temperature_with_controller(batch, delta_time);
+        update_pressure_with_controller(batch, delta_time);
+    }
+};
+
+using Thermodynamics = BasicThermodynamics<ReactorModel>;
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с кражей работы: у каждого потока своя очередь задач.
+// Поток берёт задачи с конца своей очереди, а когда она пуста - крадёт
+// с начала очереди соседа. Так длинные и короткие прогоны сами
+// выравниваются между ядрами без общего узкого места.
+class ThreadPool
+{
+public:
+	using Task = std::function<void()>;
+
+private:
+	struct Worker
+	{
+		std::mutex		 mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<Worker>> workers;
+	std::vector<std::thread>			 threads;
+
+	std::mutex				wake_mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+
+	std::atomic<std::size_t> pending{0};	 // поставлено, но ещё не выполнено
+	std::atomic<std::size_t> queued{0};	 // лежит в очередях и ещё никем не взято
+	std::atomic<std::size_t> next_queue{0}; // куда класть следующую внешнюю задачу
+	bool					 stopping = false;
+
+	bool try_pop(std::size_t index, Task& task);
+	bool try_steal(std::size_t thief, Task& task);
+	void finish_task();
+	void run(std::size_t index);
+
+public:
+	// 0 - по числу аппаратных потоков
+	explicit ThreadPool(std::size_t thread_count = 0);
+
+	ThreadPool(const ThreadPool&)			 = delete;
+	ThreadPool(ThreadPool&&)				 = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+	ThreadPool& operator=(ThreadPool&&)		 = delete;
+	~ThreadPool();
+
+	[[nodiscard]] std::size_t size() const
+	{
+		return threads.size();
+	}
+
+	// Задача не должна бросать исключения: ошибки прогона возвращаются через результат
+	void submit(Task task);
+
+	// Ждёт, пока не будут выполнены все поставленные задачи
+	void wait();
+};
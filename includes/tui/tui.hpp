@@ -1,5 +1,8 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <charconv>
 #include <cmath>
 #include <common.hpp>
 #include <cstdint>
@@ -11,7 +14,10 @@
 #include <ftxui/dom/node.hpp>
 #include <ftxui/screen/color.hpp>
 #include <memory>
+#include <optional>
 #include <sstream>
+#include <string_view>
+#include <tui_options.hpp>
 #include <unordered_map>
 #include <utility>
 #include <variant>
@@ -70,6 +76,35 @@ namespace tui
 		}
 	};
 
+	// Буфер под одно число: хватает на "-1.234e+308"
+	using NumberBuffer = std::array<char, 32>;
+
+	// Число в buffer через std::to_chars, без аллокаций. Обычные величины - fixed с двумя
+	// знаками; большие (давление в Па, 10^5..10^6) и совсем малые - scientific с четырьмя
+	// значащими, вместо длинных строк вроде "1013250.00" или нулей "0.00"
+	inline std::string_view format_number(double value, NumberBuffer& buffer)
+	{
+		constexpr double FIXED_MIN			  = 1e-2;
+		constexpr double FIXED_MAX			  = 1e5;
+		constexpr int	 FIXED_PRECISION	  = 2;
+		constexpr int	 SCIENTIFIC_PRECISION = 3;
+
+		const double magnitude = std::abs(value);
+		const bool	 fixed	   = magnitude == 0.0 || !std::isfinite(value) ||
+							 (magnitude >= FIXED_MIN && magnitude < FIXED_MAX);
+
+		char* const first  = buffer.data();
+		char* const last   = buffer.data() + buffer.size();
+		const auto	format = fixed ? std::chars_format::fixed : std::chars_format::scientific;
+		const auto	result =
+			std::to_chars(first, last, value, format, fixed ? FIXED_PRECISION : SCIENTIFIC_PRECISION);
+		if (result.ec != std::errc{})
+		{
+			return "?";
+		}
+		return {first, static_cast<std::size_t>(result.ptr - first)};
+	}
+
 	class BaseField
 	{
 		Key		key;
@@ -77,19 +112,39 @@ namespace tui
 		bool	dirty		   = true;
 
 		std::function<FieldValue()> provider;
+		NumberBuffer				number;
+		std::optional<double>		shown_number; // последнее показанное число, если оно было
 
 	protected:
-		virtual void update_value_impl(const FieldValue& value)
+		// true - видимое значение изменилось и элемент надо пересобрать
+		virtual bool update_value_impl(const FieldValue& value)
 		{
 			if (std::holds_alternative<std::string>(value))
 			{
 				cached_element = text(std::get<std::string>(value));
 			}
+			return true;
 		};
 
+		// Пишет значение в target; строка target переиспользуется, так что в установившемся
+		// режиме (та же длина или меньше) аллокаций нет. false - значение не изменилось
+		bool assign_value(std::string& target, const FieldValue& value)
+		{
+			const std::string_view next = std::holds_alternative<std::string>(value)
+											  ? std::string_view(std::get<std::string>(value))
+											  : format_number(std::get<double>(value), number);
+			if (next == target)
+			{
+				return false;
+			}
+			target.assign(next);
+			return true;
+		}
+
+		// Без своего представления поле показывает то, что положил update_value_impl
 		virtual Element element_impl()
 		{
-			return text("");
+			return cached_element;
 		};
 
 	public:
@@ -100,10 +155,23 @@ namespace tui
 		explicit BaseField(Key key) : key(std::move(key)) {}
 		virtual ~BaseField() = default;
 
-		void update_value(const FieldValue& value)
+		// true - элемент поля придётся пересобрать
+		bool update_value(const FieldValue& value)
 		{
-			dirty = true;
-			update_value_impl(value);
+			// Провайдеры чисел почти всегда отдают то же значение, что в прошлом кадре:
+			// сравниваем до форматирования. Разные числа с одной строкой отсечёт assign_value
+			const double* next_number = std::get_if<double>(&value);
+			if (next_number != nullptr && shown_number == *next_number)
+			{
+				return dirty;
+			}
+			shown_number = next_number != nullptr ? std::optional(*next_number) : std::nullopt;
+
+			if (update_value_impl(value))
+			{
+				dirty = true;
+			}
+			return dirty;
 		}
 
 		Element element()
@@ -128,16 +196,15 @@ namespace tui
 			this->provider = std::move(provider);
 		}
 
-		virtual void rerender()
+		// Перечитывает значение у провайдера. Без провайдера поле меняется только через
+		// update_value, а графики FTXUI опрашивает сам при каждой отрисовке - пересобирать нечего
+		virtual bool rerender()
 		{
 			if (provider)
 			{
-				update_value(provider());
-			}
-			else
-			{
-				dirty = true;
+				return update_value(provider());
 			}
+			return dirty;
 		}
 	};
 
@@ -154,19 +221,9 @@ namespace tui
 		std::string link;
 
 	protected:
-		void update_value_impl(const FieldValue& val) override
+		bool update_value_impl(const FieldValue& val) override
 		{
-			if (std::holds_alternative<std::string>(val))
-			{
-				value = std::get<std::string>(val);
-			}
-			else
-			{
-				// if double then use precision 2
-				std::ostringstream oss;
-				oss << std::fixed << std::setprecision(2) << std::get<double>(val);
-				value = oss.str();
-			}
+			return assign_value(value, val);
 		}
 
 		Element element_impl() override
@@ -202,19 +259,9 @@ namespace tui
 		std::string value;
 
 	protected:
-		void update_value_impl(const FieldValue& val) override
+		bool update_value_impl(const FieldValue& val) override
 		{
-			if (std::holds_alternative<std::string>(val))
-			{
-				value = std::get<std::string>(val);
-			}
-			else
-			{
-				// if double then use precision 2
-				std::ostringstream oss;
-				oss << std::fixed << std::setprecision(2) << std::get<double>(val);
-				value = oss.str();
-			}
+			return assign_value(value, val);
 		}
 
 		Element element_impl() override
@@ -240,25 +287,28 @@ namespace tui
 		Fields										fields;
 		std::unordered_map<std::string, BaseField*> index; // lookup by id
 
+		// Собранный vbox полей; пересобирается, только если какое-то поле изменилось
+		mutable Element cached_element;
+		mutable bool	changed = true;
+
 		void add(Field field)
 		{
 			index[field->get_key()] = field.get();
 			fields.push_back(std::move(field));
+			changed = true;
 		}
 
-		template <class Obj, class MemFn> void add_auto(const std::string& key, Obj* obj, MemFn fun)
+		// source - кадр, который окно обновляет из State::snapshot() перед rerender_all(),
+		// так все поля одного кадра показывают одно и то же состояние
+		void add_auto(const std::string& key, const Environment* source, double Environment::* member)
 		{
 			auto ptr = std::make_unique<TextField>(KeyValuePair{.key = key, .val = ""});
 
-			ptr->set_provider(
-				[obj, fun]
-				{
-					std::scoped_lock lock(obj->mutex);
-					return FieldValue((obj->*fun)());
-				});
+			ptr->set_provider([source, member] { return FieldValue(source->*member); });
 
 			index[key] = ptr.get();
 			fields.push_back(std::move(ptr));
+			changed = true;
 		}
 
 		void update_by_key(const Key& key, const FieldValue& value)
@@ -267,7 +317,7 @@ namespace tui
 
 			if (item != index.end())
 			{
-				item->second->update_value(value);
+				changed = item->second->update_value(value) || changed;
 			}
 		}
 
@@ -285,24 +335,28 @@ namespace tui
 
 		Element element() const
 		{
-			return vbox(elements());
+			if (changed || !cached_element)
+			{
+				cached_element = vbox(elements());
+				changed		   = false;
+			}
+			return cached_element;
 		}
 
 		void rerender_all()
 		{
 			for (auto& field : fields)
 			{
-				field->rerender();
+				changed = field->rerender() || changed;
 			}
 		}
 
-		void
-		add_auto_many(State*																   obj,
-					  std::initializer_list<std::pair<std::string, double (State::*)() const>> list)
+		void add_auto_many(const Environment*													source,
+						   std::initializer_list<std::pair<std::string, double Environment::*>> list)
 		{
 			for (const auto& item : list)
 			{
-				add_auto(item.first, obj, item.second);
+				add_auto(item.first, source, item.second);
 			}
 		}
 	};
@@ -312,6 +366,10 @@ namespace tui
 		std::string name;
 		Content		content;
 
+		// Окно пересобирается, только когда Content вернул новый элемент
+		mutable Element shown_content;
+		mutable Element cached_element;
+
 	public:
 		ContentCell(const ContentCell&)			   = default;
 		ContentCell(ContentCell&&)				   = default;
@@ -332,7 +390,13 @@ namespace tui
 
 		Element element() const
 		{
-			return window(text(name), content.element());
+			Element current = content.element();
+			if (current != shown_content || !cached_element)
+			{
+				cached_element = window(text(name), current);
+				shown_content  = std::move(current);
+			}
+			return cached_element;
 		}
 	};
 
@@ -478,6 +542,55 @@ namespace tui
 		return std::make_unique<GraphField>(data);
 	}
 
+	// График поля из истории State за всё сохранённое время. Колонка - огибающая min/max
+	// из пирамиды истории, рисуется тот её край, что дальше от середины шкалы:
+	// одиночные выбросы остаются видны в обе стороны при любой ширине
+	inline std::unique_ptr<GraphField> make_history_graph(State* state, EnvironmentField field,
+														  const std::string& name)
+	{
+		auto ptr = make_graph_field({.is_fake = false, .name = name});
+		ptr->set_provider(
+			[state, field](int width, int height) -> std::vector<int>
+			{
+				if (width <= 0 || height <= 0)
+				{
+					return {};
+				}
+
+				const History& history	= state->get_history();
+				auto		   envelope = history.envelope(
+					  static_cast<std::size_t>(field), history.oldest_time(), history.newest_time(),
+					  static_cast<std::size_t>(width));
+
+				std::vector<int> output(static_cast<std::size_t>(width), 0);
+				if (envelope.minimum.empty())
+				{
+					return output;
+				}
+
+				double low	= *std::ranges::min_element(envelope.minimum);
+				double high = *std::ranges::max_element(envelope.maximum);
+				if (!(high - low > 0.0))
+				{
+					// Ровная линия - посередине графика
+					low -= 1.0;
+					high += 1.0;
+				}
+				const double middle = (low + high) / 2.0;
+				const double scale	= static_cast<double>(height - 1) / (high - low);
+
+				for (std::size_t column = 0; column < output.size(); ++column)
+				{
+					double value = envelope.maximum[column] - middle > middle - envelope.minimum[column]
+									   ? envelope.maximum[column]
+									   : envelope.minimum[column];
+					output[column] = static_cast<int>(std::lround((value - low) * scale));
+				}
+				return output;
+			});
+		return ptr;
+	}
+
 	inline std::unique_ptr<TextField> make_text_field_provider(const Key&				   key,
 															   std::function<FieldValue()> provider)
 	{
@@ -525,7 +638,14 @@ namespace tui
 	class StatWindow : public Window
 	{
 		State*		state;
+		Snapshot	frame; // копия состояния для текущего кадра
 		ContentCell indicators;
+		ContentCell graphs;
+
+		// Раскладка вкладки; пересобирается, только если сменилось одно из окон
+		Element shown_indicators;
+		Element shown_graphs;
+		Element layout;
 
 	public:
 		StatWindow(const StatWindow&)			 = default;
@@ -534,34 +654,157 @@ namespace tui
 		StatWindow& operator=(StatWindow&&)		 = default;
 		~StatWindow() override					 = default;
 
-		explicit StatWindow(State* state) : state(state), indicators("Indicators")
+		explicit StatWindow(State* state)
+			: state(state), frame(state->snapshot()), indicators("Indicators"), graphs("History")
 		{
 			set_name("stats");
 
 			indicators.get_content().add_auto_many(
-				state, {{"Temp (K)", &State::get_temperature},
-						{"Needed temp (K)", &State::get_needed_temperature},
-						{"Pressure (Pa)", &State::get_pressure},
-						{"Needed pressure (Pa)", &State::get_needed_pressure},
-						{"Humidity (%)", &State::get_humidity},
-						{"Needed humidity (%)", &State::get_needed_humidity},
-						{"Mass (kg)", &State::get_mass},
-						{"Volume (m^3)", &State::get_volume},
-						{"Specific gas const (J/kg*K)", &State::get_specific_gas_constant},
-						{"Heat capacity (J/kg*K)", &State::get_heat_capacity},
-						{"Thermal conductivity (W/m*K)", &State::get_thermal_conductivity},
-						{"Surface area (m^2)", &State::get_surface_area},
-						{"Wall thickness (m)", &State::get_wall_thickness},
-						{"Wall thermal cond. (W/m*K)", &State::get_wall_thermal_conductivity},
-						{"Ambient temp (K)", &State::get_ambient_temperature},
-						{"Heat transfer coeff. (W/m^2*K)", &State::get_heat_transfer_coefficient},
-						{"Reaction heat rate (W)", &State::get_reaction_heat_rate},
-						{"Cooling rate (W)", &State::get_cooling_rate},
-						{"Heating rate (W)", &State::get_heating_rate}});
+				&frame.environment,
+				{{"Temp (K)", &Environment::temperature},
+				 {"Needed temp (K)", &Environment::needed_temperature},
+				 {"Pressure (Pa)", &Environment::pressure},
+				 {"Needed pressure (Pa)", &Environment::needed_pressure},
+				 {"Humidity (%)", &Environment::humidity},
+				 {"Needed humidity (%)", &Environment::needed_humidity},
+				 {"Mass (kg)", &Environment::mass},
+				 {"Volume (m^3)", &Environment::volume},
+				 {"Specific gas const (J/kg*K)", &Environment::specific_gas_constant},
+				 {"Heat capacity (J/kg*K)", &Environment::heat_capacity},
+				 {"Thermal conductivity (W/m*K)", &Environment::thermal_conductivity},
+				 {"Surface area (m^2)", &Environment::surface_area},
+				 {"Wall thickness (m)", &Environment::wall_thickness},
+				 {"Wall thermal cond. (W/m*K)", &Environment::wall_thermal_conductivity},
+				 {"Ambient temp (K)", &Environment::ambient_temperature},
+				 {"Heat transfer coeff. (W/m^2*K)", &Environment::heat_transfer_coefficient},
+				 {"Reaction heat rate (W)", &Environment::reaction_heat_rate},
+				 {"Cooling rate (W)", &Environment::cooling_rate},
+				 {"Heating rate (W)", &Environment::heating_rate}});
+
+			graphs.get_content().add(
+				make_history_graph(state, EnvironmentField::TEMPERATURE, "Temp (K)"));
+			graphs.get_content().add(
+				make_history_graph(state, EnvironmentField::PRESSURE, "Pressure (Pa)"));
+			graphs.get_content().add(
+				make_history_graph(state, EnvironmentField::HUMIDITY, "Humidity (%)"));
+		}
+		Component component() override;
+	};
+
+	// Длительность в наносекундах с единицей под порядок величины: 850ns, 12.4us, 3.1ms
+	inline std::string format_duration(std::uint64_t nanoseconds)
+	{
+		constexpr std::uint64_t NANOS_IN_MICRO = 1000;
+		constexpr std::uint64_t NANOS_IN_MILLI = 1000 * NANOS_IN_MICRO;
+
+		std::ostringstream out;
+		out.setf(std::ios::fixed);
+		out.precision(1);
+		if (nanoseconds < NANOS_IN_MICRO)
+		{
+			out << nanoseconds << "ns";
+		}
+		else if (nanoseconds < NANOS_IN_MILLI)
+		{
+			out << static_cast<double>(nanoseconds) / NANOS_IN_MICRO << "us";
+		}
+		else
+		{
+			out << static_cast<double>(nanoseconds) / NANOS_IN_MILLI << "ms";
+		}
+		return out.str();
+	}
+
+	// p50/p99/max по стадиям тика из гистограмм State::get_profile()
+	class ProfileWindow : public Window
+	{
+		State*		state;
+		ContentCell stages;
+
+	public:
+		ProfileWindow(const ProfileWindow&)			   = default;
+		ProfileWindow(ProfileWindow&&)				   = default;
+		ProfileWindow& operator=(const ProfileWindow&) = default;
+		ProfileWindow& operator=(ProfileWindow&&)	   = default;
+		~ProfileWindow() override					   = default;
+
+		explicit ProfileWindow(State* state) : state(state), stages("Tick profile")
+		{
+			set_name("profile");
+
+			if constexpr (!PROFILING_ENABLED)
+			{
+				stages.get_content().add(make_text_field(
+					{.key = "Profiling", .val = "compiled out (REACTOR_PROFILING=OFF)"}));
+				return;
+			}
+
+			for (std::size_t index = 0; index < PROFILE_STAGE_COUNT; ++index)
+			{
+				const auto stage = static_cast<ProfileStage>(index);
+				stages.get_content().add(make_text_field_provider(
+					std::string(PROFILE_STAGE_NAMES[index]),
+					[state, stage]() -> FieldValue
+					{
+						const auto summary = state->get_profile().summary(stage);
+						if (summary.count == 0)
+						{
+							return std::string("-");
+						}
+						return "p50 " + format_duration(summary.p50) + "  p99 " +
+							   format_duration(summary.p99) + "  max " +
+							   format_duration(summary.max) + "  (n=" +
+							   std::to_string(summary.count) + ")";
+					}));
+			}
 		}
 		Component component() override;
 	};
 
+	// Статус, активные тревоги и журнал событий из State::get_alarm_log()
+	class AlarmWindow : public Window
+	{
+		static constexpr std::size_t SHOWN_EVENTS = 50;
+
+		State*					state;
+		std::uint64_t			seen_version = 0;
+		std::vector<AlarmEvent> active;
+		std::vector<AlarmEvent> events; // новые сверху
+
+	public:
+		AlarmWindow(const AlarmWindow&)			   = default;
+		AlarmWindow(AlarmWindow&&)				   = default;
+		AlarmWindow& operator=(const AlarmWindow&) = default;
+		AlarmWindow& operator=(AlarmWindow&&)	   = default;
+		~AlarmWindow() override					   = default;
+
+		explicit AlarmWindow(State* state) : state(state)
+		{
+			set_name("alarms");
+		}
+
+		// Копирует журнал, только если в нём что-то изменилось
+		void refresh()
+		{
+			const AlarmLog& log		= state->get_alarm_log();
+			const auto		version = log.version();
+			if (version == seen_version)
+			{
+				return;
+			}
+			seen_version = version;
+			active		 = log.active_alarms();
+			events		 = log.recent();
+			std::ranges::reverse(events);
+			if (events.size() > SHOWN_EVENTS)
+			{
+				events.resize(SHOWN_EVENTS);
+			}
+		}
+
+		Component component() override;
+	};
+
 	class Bar
 	{
 		State* state;
@@ -569,11 +812,15 @@ namespace tui
 		std::vector<std::string> tab_names;
 		int						 tab_selected = 0;
 
-		MainWindow main_window;
-		StatWindow stat_window;
+		MainWindow	  main_window;
+		StatWindow	  stat_window;
+		ProfileWindow profile_window;
+		AlarmWindow	  alarm_window;
 
 		Component main_component;
 		Component stat_component;
+		Component profile_component;
+		Component alarm_component;
 
 	public:
 		Component component();
@@ -584,21 +831,31 @@ namespace tui
 		Bar& operator=(Bar&&)	   = default;
 		~Bar()					   = default;
 
-		explicit Bar(State* state) : state(state), main_window(state), stat_window(state)
-		{
-			tab_names = std::vector<std::string>({main_window.get_name(), stat_window.get_name()});
-
-			main_component = main_window.component();
-			stat_component = stat_window.component();
+		explicit Bar(State* state)
+			: state(state),
+			  main_window(state),
+			  stat_window(state),
+			  profile_window(state),
+			  alarm_window(state)
+		{
+			tab_names = std::vector<std::string>({main_window.get_name(), stat_window.get_name(),
+												  profile_window.get_name(),
+												  alarm_window.get_name()});
+
+			main_component	  = main_window.component();
+			stat_component	  = stat_window.component();
+			profile_component = profile_window.component();
+			alarm_component	  = alarm_window.component();
 		};
 	};
 
 	class Instance
 	{
-		State*		state;
+		State*	   state;
+		TuiOptions options;
 
 	public:
-		explicit Instance(State* state) : state(state) {}
+		Instance(State* state, TuiOptions options) : state(state), options(options) {}
 
 		Instance(const Instance&)			 = delete;
 		Instance(Instance&&)				 = default;
@@ -0,0 +1,262 @@
+#include "../../includes/simulation/alarms.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
+#include <utility>
+
+namespace
+{
+	constexpr std::size_t severity_index(StatusMode severity)
+	{
+		return severity == StatusMode::CRITICAL ? 1 : 0;
+	}
+
+	constexpr bool is_rate(AlarmCondition condition)
+	{
+		return condition == AlarmCondition::RATE_ABOVE || condition == AlarmCondition::RATE_BELOW;
+	}
+
+	constexpr bool is_upper(AlarmCondition condition)
+	{
+		return condition == AlarmCondition::ABOVE || condition == AlarmCondition::RATE_ABOVE;
+	}
+
+	EnvironmentField parse_field(const std::string& alarm, const std::string& name)
+	{
+		for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+		{
+			if (ENVIRONMENT_FIELDS[field].name == name)
+			{
+				return static_cast<EnvironmentField>(field);
+			}
+		}
+		throw AlarmError("alarm '" + alarm + "': unknown field '" + name + "'");
+	}
+} // namespace
+
+std::shared_ptr<const AlarmRules> AlarmRules::compile(const std::vector<AlarmRuleConfig>& configs,
+													  const std::vector<SensorRange>&	  sensors)
+{
+	auto							result = std::make_shared<AlarmRules>();
+	std::unordered_set<std::string> names;
+
+	auto add = [&result, &names](AlarmRule rule)
+	{
+		if (!names.insert(rule.name).second)
+		{
+			throw AlarmError("duplicate alarm name '" + rule.name + "'");
+		}
+		const auto index = static_cast<std::uint32_t>(result->rules.size());
+		const auto field = static_cast<std::size_t>(rule.field);
+		(is_rate(rule.condition) ? result->rate_rules : result->level_rules)[field].push_back(index);
+		result->rules.push_back(std::move(rule));
+	};
+
+	for (const SensorRange& sensor : sensors)
+	{
+		add({.name		 = sensor.name + ".low",
+			 .field		 = sensor.field,
+			 .condition	 = AlarmCondition::BELOW,
+			 .threshold	 = sensor.min_value,
+			 .hysteresis = 0.0,
+			 .for_millis = 0,
+			 .severity	 = StatusMode::CRITICAL});
+		add({.name		 = sensor.name + ".high",
+			 .field		 = sensor.field,
+			 .condition	 = AlarmCondition::ABOVE,
+			 .threshold	 = sensor.max_value,
+			 .hysteresis = 0.0,
+			 .for_millis = 0,
+			 .severity	 = StatusMode::CRITICAL});
+	}
+
+	for (const AlarmRuleConfig& config : configs)
+	{
+		add({.name		 = config.name,
+			 .field		 = parse_field(config.name, config.field),
+			 .condition	 = config.condition,
+			 .threshold	 = config.threshold,
+			 .hysteresis = config.hysteresis,
+			 .for_millis = config.for_ms,
+			 .severity	 = config.severity == AlarmSeverity::CRITICAL ? StatusMode::CRITICAL
+																	  : StatusMode::WARNING});
+	}
+
+	return result;
+}
+
+AlarmEngine::AlarmEngine(std::shared_ptr<const AlarmRules> rules)
+{
+	set_rules(std::move(rules));
+}
+
+void AlarmEngine::set_rules(std::shared_ptr<const AlarmRules> value)
+{
+	rules = std::move(value);
+	states.assign(rules->size(), RuleState{});
+	deadlines.clear();
+	primed			  = false;
+	changed_last_tick = {};
+	active_counts	  = {};
+}
+
+void AlarmEngine::raise(std::uint32_t index, double value, unsigned long now, AlarmLog& log)
+{
+	const AlarmRule& rule = (*rules)[index];
+	states[index].active  = true;
+	++active_counts[severity_index(rule.severity)];
+	log.record({.name			 = rule.name,
+				.rule			 = index,
+				.severity		 = rule.severity,
+				.raised			 = true,
+				.value			 = value,
+				.sim_time_millis = now});
+}
+
+void AlarmEngine::update_rule(std::uint32_t index, double value, unsigned long now, AlarmLog& log)
+{
+	const AlarmRule& rule  = (*rules)[index];
+	RuleState&		 state = states[index];
+	state.value			   = value;
+
+	// Выполненное условие держится, пока значение не отойдёт от порога на hysteresis
+	const bool	 upper = is_upper(rule.condition);
+	const double limit = !state.condition ? rule.threshold
+						 : upper		  ? rule.threshold - rule.hysteresis
+										  : rule.threshold + rule.hysteresis;
+	// Сравнения с NaN ложны: условие записано как "не в норме", поэтому нечисло (разошедшееся
+	// состояние) выполняет и верхние, и нижние правила, а не снимает их
+	const bool condition = upper ? !(value <= limit) : !(value >= limit);
+	if (condition == state.condition)
+	{
+		return;
+	}
+
+	state.condition = condition;
+	if (condition)
+	{
+		if (rule.for_millis == 0)
+		{
+			raise(index, value, now, log);
+		}
+		else
+		{
+			deadlines.push_back({.due_millis = now + rule.for_millis,
+								 .rule		 = index,
+								 .generation = state.generation});
+			std::push_heap(deadlines.begin(), deadlines.end(), std::greater<>{});
+		}
+		return;
+	}
+
+	++state.generation;
+	if (state.active)
+	{
+		state.active = false;
+		--active_counts[severity_index(rule.severity)];
+		log.record({.name			 = rule.name,
+					.rule			 = index,
+					.severity		 = rule.severity,
+					.raised			 = false,
+					.value			 = value,
+					.sim_time_millis = now});
+	}
+}
+
+StatusMode AlarmEngine::evaluate(unsigned long sim_time_millis, const Environment& env,
+								 AlarmLog& log)
+{
+	const double MILLIS_IN_SEC = 1000.0;
+	const double elapsed	   = primed && sim_time_millis > previous_millis
+									 ? static_cast<double>(sim_time_millis - previous_millis) /
+										   MILLIS_IN_SEC
+									 : 0.0;
+
+	for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		const auto	 member	 = ENVIRONMENT_FIELDS[field].member;
+		const double value	 = env.*member;
+		const bool	 changed = !primed || value != previous.*member;
+
+		if (changed)
+		{
+			for (const std::uint32_t index : rules->level_rules_of(field))
+			{
+				update_rule(index, value, sim_time_millis, log);
+			}
+		}
+
+		// Скорость пересчитывается и на тике после изменения: поле встало - скорость стала 0
+		const auto& rate_rules = rules->rate_rules_of(field);
+		if (!rate_rules.empty() && (changed || changed_last_tick[field]))
+		{
+			const double rate = elapsed > 0.0 ? (value - previous.*member) / elapsed : 0.0;
+			for (const std::uint32_t index : rate_rules)
+			{
+				update_rule(index, rate, sim_time_millis, log);
+			}
+		}
+		changed_last_tick[field] = primed && changed;
+	}
+
+	previous		= env;
+	previous_millis = sim_time_millis;
+	primed			= true;
+
+	// Сроки for_ms, наступившие к концу тика
+	while (!deadlines.empty() && deadlines.front().due_millis <= sim_time_millis)
+	{
+		std::pop_heap(deadlines.begin(), deadlines.end(), std::greater<>{});
+		const Deadline deadline = deadlines.back();
+		deadlines.pop_back();
+
+		const RuleState& state = states[deadline.rule];
+		if (deadline.generation == state.generation && state.condition && !state.active)
+		{
+			raise(deadline.rule, state.value, sim_time_millis, log);
+		}
+	}
+
+	if (active_counts[severity_index(StatusMode::CRITICAL)] > 0)
+	{
+		return StatusMode::CRITICAL;
+	}
+	if (active_counts[severity_index(StatusMode::WARNING)] > 0)
+	{
+		return StatusMode::WARNING;
+	}
+	return StatusMode::NORMAL;
+}
+
+void AlarmEngine::set_resume(const Resume& resume, AlarmLog& log)
+{
+	if (resume.states.size() != rules->size())
+	{
+		throw AlarmError("alarm state has " + std::to_string(resume.states.size()) +
+						 " rules, expected " + std::to_string(rules->size()));
+	}
+
+	states			  = resume.states;
+	deadlines		  = resume.deadlines;
+	previous		  = resume.previous;
+	previous_millis	  = resume.previous_millis;
+	primed			  = resume.primed;
+	changed_last_tick = resume.changed_last_tick;
+
+	active_counts = {};
+	for (std::uint32_t index = 0; index < states.size(); ++index)
+	{
+		if (states[index].active)
+		{
+			const AlarmRule& rule = (*rules)[index];
+			++active_counts[severity_index(rule.severity)];
+			log.record({.name			 = rule.name,
+						.rule			 = index,
+						.severity		 = rule.severity,
+						.raised			 = true,
+						.value			 = states[index].value,
+						.sim_time_millis = previous_millis});
+		}
+	}
+}
@@ -0,0 +1,434 @@
+#include "../../includes/simulation/checkpoint.hpp"
+
+#include "defs.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifdef REACTOR_POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr std::array<char, 8> MAGIC{'R', 'C', 'T', 'C', 'H', 'K', '0', '4'};
+
+	// Поля пишутся по одному, без паддинга структур; в конце - FNV-1a всех предыдущих байт
+	class Encoder
+	{
+		std::vector<char> bytes;
+
+	public:
+		template <class T> void put(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			const auto* begin = reinterpret_cast<const char*>(&value); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+			bytes.insert(bytes.end(), begin, begin + sizeof(T));
+		}
+
+		void put_text(std::string_view text)
+		{
+			put(static_cast<std::uint64_t>(text.size()));
+			bytes.insert(bytes.end(), text.begin(), text.end());
+		}
+
+		[[nodiscard]] const std::vector<char>& data() const
+		{
+			return bytes;
+		}
+	};
+
+	class Decoder
+	{
+		const std::vector<char>& bytes;
+		std::size_t				 offset = 0;
+		const std::string&		 path;
+
+	public:
+		Decoder(const std::vector<char>& bytes, const std::string& path) : bytes(bytes), path(path) {}
+
+		template <class T> T get()
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			if (offset + sizeof(T) > bytes.size())
+			{
+				throw CheckpointError("checkpoint '" + path + "' is truncated");
+			}
+			T value;
+			std::memcpy(static_cast<void*>(&value), bytes.data() + offset, sizeof(T));
+			offset += sizeof(T);
+			return value;
+		}
+
+		// bool и перечисления пишутся одним байтом; читаем байт и проверяем диапазон, а не
+		// копируем байты прямо в bool или enum (значение вне диапазона - неопределённое поведение)
+		template <class T> T get_enum(std::uint8_t count)
+		{
+			const auto raw = get<std::uint8_t>();
+			if (raw >= count)
+			{
+				throw CheckpointError("checkpoint '" + path + "' is corrupted");
+			}
+			return static_cast<T>(raw);
+		}
+
+		bool get_bool()
+		{
+			return get_enum<std::uint8_t>(2) != 0;
+		}
+
+		[[nodiscard]] std::size_t position() const
+		{
+			return offset;
+		}
+	};
+
+	std::uint64_t fnv1a(const char* data, std::size_t size)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325ULL;
+		for (std::size_t i = 0; i < size; ++i)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 0x100000001b3ULL;
+		}
+		return hash;
+	}
+
+	// Отпечаток набора правил тревог: состояние движка восстанавливается только для тех же правил
+	std::uint64_t rules_fingerprint(const AlarmRules& rules)
+	{
+		Encoder encoder;
+		for (std::size_t index = 0; index < rules.size(); ++index)
+		{
+			const AlarmRule& rule = rules[index];
+			encoder.put_text(rule.name);
+			encoder.put(static_cast<std::uint8_t>(rule.field));
+			encoder.put(static_cast<std::uint8_t>(rule.condition));
+			encoder.put(rule.threshold);
+			encoder.put(rule.hysteresis);
+			encoder.put(static_cast<std::uint64_t>(rule.for_millis));
+			encoder.put(static_cast<std::uint8_t>(rule.severity));
+		}
+		return fnv1a(encoder.data().data(), encoder.data().size());
+	}
+
+	// Записывает bytes в path и сбрасывает на диск (fsync) до возврата: иначе после падения
+	// машины rename может оказаться на диске раньше данных, и на месте точки будет обрывок
+	void write_durably(const std::string& path, const std::vector<char>& bytes)
+	{
+#ifdef REACTOR_POSIX
+		const int file = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644); // NOLINT(cppcoreguidelines-pro-type-vararg)
+		if (file < 0)
+		{
+			throw CheckpointError("Failed to write checkpoint: " + path + ": " +
+								  std::strerror(errno));
+		}
+
+		std::size_t written = 0;
+		while (written < bytes.size())
+		{
+			const ssize_t count = ::write(file, bytes.data() + written, bytes.size() - written);
+			if (count < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (count <= 0)
+			{
+				const int error = errno;
+				::close(file);
+				throw CheckpointError("Failed to write checkpoint: " + path + ": " +
+									  std::strerror(error));
+			}
+			written += static_cast<std::size_t>(count);
+		}
+
+		const bool synced	  = ::fsync(file) == 0;
+		const int  sync_error = errno;
+		const bool closed	  = ::close(file) == 0;
+		if (!synced || !closed)
+		{
+			throw CheckpointError("Failed to write checkpoint: " + path + ": " +
+								  std::strerror(synced ? errno : sync_error));
+		}
+#else
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+		out.flush();
+		if (!out)
+		{
+			throw CheckpointError("Failed to write checkpoint: " + path);
+		}
+#endif
+	}
+
+	// Сбрасывает каталог, чтобы сам rename пережил падение машины
+	void sync_directory([[maybe_unused]] const std::string& path)
+	{
+#ifdef REACTOR_POSIX
+		std::string directory = std::filesystem::path(path).parent_path().string();
+		if (directory.empty())
+		{
+			directory = ".";
+		}
+		const int file = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+		if (file >= 0)
+		{
+			::fsync(file);
+			::close(file);
+		}
+#endif
+	}
+} // namespace
+
+void save_checkpoint(const Simulation& simulation, const std::string& path)
+{
+	const State&	  state		 = simulation.state;
+	const Integrator& integrator = simulation.get_integrator();
+
+	Encoder encoder;
+	encoder.put(MAGIC);
+	encoder.put(static_cast<std::uint64_t>(simulation.get_current_time_millis()));
+	encoder.put(state.get_environment());
+	encoder.put(static_cast<std::uint8_t>(state.get_control_mode()));
+	encoder.put(static_cast<std::uint8_t>(state.get_status_mode()));
+
+	const ControllerGains& gains = state.get_controller_gains();
+	encoder.put(gains.temperature_band);
+	encoder.put(gains.pressure_kp);
+	encoder.put(gains.humidity_kp);
+
+	const IntegratorSettings& settings = integrator.get_settings();
+	encoder.put(static_cast<std::uint8_t>(settings.mode));
+	encoder.put(settings.relative_tolerance);
+	encoder.put(settings.absolute_tolerance);
+	encoder.put(settings.min_step);
+	encoder.put(settings.max_step);
+
+	const IntegratorResume resume = integrator.get_resume();
+	encoder.put(resume.step_hint);
+	encoder.put(resume.previous);
+	encoder.put(resume.last_output);
+	encoder.put(resume.previous_step);
+	encoder.put(static_cast<std::uint8_t>(resume.has_history ? 1 : 0));
+
+	const IntegratorStats& stats = integrator.get_stats();
+	encoder.put(static_cast<std::uint64_t>(stats.accepted_steps));
+	encoder.put(static_cast<std::uint64_t>(stats.rejected_steps));
+	encoder.put(static_cast<std::uint64_t>(stats.rhs_evaluations));
+	encoder.put(static_cast<std::uint64_t>(stats.newton_iterations));
+	encoder.put(static_cast<std::uint64_t>(stats.newton_failures));
+	encoder.put(static_cast<std::uint64_t>(stats.failed_ticks));
+	encoder.put(static_cast<std::uint8_t>(simulation.has_solver_alarm() ? 1 : 0));
+
+	// Накопленное время подсистем: периоды берутся из конфигурации, а фаза - отсюда
+	for (const unsigned long pending : simulation.get_scheduler().get_pending())
+	{
+		encoder.put(static_cast<std::uint64_t>(pending));
+	}
+
+	const AlarmEngine&		  alarms = simulation.get_alarm_engine();
+	const AlarmEngine::Resume alarm	 = alarms.get_resume();
+	encoder.put(rules_fingerprint(*alarms.get_rules()));
+	encoder.put(static_cast<std::uint64_t>(alarm.states.size()));
+	for (const AlarmEngine::RuleState& rule : alarm.states)
+	{
+		encoder.put(static_cast<std::uint8_t>(rule.condition ? 1 : 0));
+		encoder.put(static_cast<std::uint8_t>(rule.active ? 1 : 0));
+		encoder.put(rule.generation);
+		encoder.put(rule.value);
+	}
+	encoder.put(static_cast<std::uint64_t>(alarm.deadlines.size()));
+	for (const AlarmEngine::Deadline& deadline : alarm.deadlines)
+	{
+		encoder.put(static_cast<std::uint64_t>(deadline.due_millis));
+		encoder.put(deadline.rule);
+		encoder.put(deadline.generation);
+	}
+	encoder.put(alarm.previous);
+	encoder.put(static_cast<std::uint64_t>(alarm.previous_millis));
+	encoder.put(static_cast<std::uint8_t>(alarm.primed ? 1 : 0));
+	for (const bool changed : alarm.changed_last_tick)
+	{
+		encoder.put(static_cast<std::uint8_t>(changed ? 1 : 0));
+	}
+
+	encoder.put(fnv1a(encoder.data().data(), encoder.data().size()));
+
+	const std::string temporary = path + ".tmp";
+	write_durably(temporary, encoder.data());
+
+	std::error_code error;
+	std::filesystem::rename(temporary, path, error);
+	if (error)
+	{
+		throw CheckpointError("Failed to write checkpoint: " + path + ": " + error.message());
+	}
+	sync_directory(path);
+}
+
+void restore_checkpoint(Simulation& simulation, const std::string& path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in.is_open())
+	{
+		throw CheckpointError("Failed to open checkpoint: " + path);
+	}
+	std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+	Decoder decoder(bytes, path);
+	if (decoder.get<std::array<char, 8>>() != MAGIC)
+	{
+		throw CheckpointError("'" + path + "' is not a reactor checkpoint");
+	}
+
+	const auto time_millis	= decoder.get<std::uint64_t>();
+	const auto environment	= decoder.get<Environment>();
+	const auto control_mode = decoder.get_enum<ControlMode>(2);
+	const auto status_mode	= decoder.get_enum<StatusMode>(3);
+
+	ControllerGains gains;
+	gains.temperature_band = decoder.get<double>();
+	gains.pressure_kp	   = decoder.get<double>();
+	gains.humidity_kp	   = decoder.get<double>();
+
+	IntegratorSettings settings;
+	settings.mode				= decoder.get_enum<IntegratorMode>(4);
+	settings.relative_tolerance = decoder.get<double>();
+	settings.absolute_tolerance = decoder.get<double>();
+	settings.min_step			= decoder.get<double>();
+	settings.max_step			= decoder.get<double>();
+
+	IntegratorResume resume;
+	resume.step_hint	 = decoder.get<double>();
+	resume.previous		 = decoder.get<ReactorOde::Vector>();
+	resume.last_output	 = decoder.get<ReactorOde::Vector>();
+	resume.previous_step = decoder.get<double>();
+	resume.has_history	 = decoder.get_bool();
+
+	IntegratorStats stats;
+	stats.accepted_steps	= decoder.get<std::uint64_t>();
+	stats.rejected_steps	= decoder.get<std::uint64_t>();
+	stats.rhs_evaluations	= decoder.get<std::uint64_t>();
+	stats.newton_iterations = decoder.get<std::uint64_t>();
+	stats.newton_failures	= decoder.get<std::uint64_t>();
+	stats.failed_ticks		= decoder.get<std::uint64_t>();
+	const bool solver_alarm = decoder.get_bool();
+
+	std::array<unsigned long, SUBSYSTEM_COUNT> pending{};
+	for (unsigned long& value : pending)
+	{
+		value = static_cast<unsigned long>(decoder.get<std::uint64_t>());
+	}
+
+	const auto			alarm_rules = decoder.get<std::uint64_t>();
+	AlarmEngine::Resume alarm;
+	for (auto count = decoder.get<std::uint64_t>(); count > 0; --count)
+	{
+		alarm.states.push_back({.condition	= decoder.get_bool(),
+								.active		= decoder.get_bool(),
+								.generation = decoder.get<std::uint32_t>(),
+								.value		= decoder.get<double>()});
+	}
+	for (auto count = decoder.get<std::uint64_t>(); count > 0; --count)
+	{
+		alarm.deadlines.push_back(
+			{.due_millis = static_cast<unsigned long>(decoder.get<std::uint64_t>()),
+			 .rule		 = decoder.get<std::uint32_t>(),
+			 .generation = decoder.get<std::uint32_t>()});
+	}
+	alarm.previous		  = decoder.get<Environment>();
+	alarm.previous_millis = static_cast<unsigned long>(decoder.get<std::uint64_t>());
+	alarm.primed		  = decoder.get_bool();
+	for (bool& changed : alarm.changed_last_tick)
+	{
+		changed = decoder.get_bool();
+	}
+
+	const std::size_t payload = decoder.position();
+	if (decoder.get<std::uint64_t>() != fnv1a(bytes.data(), payload) ||
+		decoder.position() != bytes.size())
+	{
+		throw CheckpointError("checkpoint '" + path + "' is corrupted");
+	}
+	const bool deadlines_valid =
+		std::is_heap(alarm.deadlines.begin(), alarm.deadlines.end(), std::greater<>{}) &&
+		std::ranges::all_of(alarm.deadlines, [&alarm](const AlarmEngine::Deadline& deadline)
+							{ return deadline.rule < alarm.states.size(); });
+	if (!deadlines_valid)
+	{
+		throw CheckpointError("checkpoint '" + path + "' is corrupted");
+	}
+
+	// Всё прочитано и проверено - только теперь трогаем симуляцию
+	State& state = simulation.state;
+	state.set_environment(environment);
+	state.set_control_mode(control_mode);
+	state.set_status_mode(status_mode);
+	state.set_controller_gains(gains);
+
+	Integrator& integrator = simulation.get_integrator();
+	integrator.set_settings(settings);
+	integrator.set_resume(resume);
+	integrator.set_stats(stats);
+
+	simulation.get_scheduler().set_pending(pending);
+
+	// С другими правилами (поменяли [[alarm]] в конфигурации) состояние движка не подходит:
+	// проверка начинается заново, активные условия поднимаются на первом тике
+	AlarmEngine& alarms = simulation.get_alarm_engine();
+	if (alarm_rules == rules_fingerprint(*alarms.get_rules()) &&
+		alarm.states.size() == alarms.get_rules()->size())
+	{
+		alarms.set_resume(alarm, state.get_alarm_log());
+	}
+
+	simulation.set_current_time_millis(time_millis);
+	simulation.set_solver_alarm(solver_alarm);
+}
+
+Checkpointer::Checkpointer(Simulation& simulation, std::string path, unsigned long interval_millis)
+	: simulation(simulation),
+	  path(std::move(path)),
+	  interval_millis(interval_millis),
+	  next_due(simulation.get_current_time_millis() + interval_millis)
+{
+}
+
+void Checkpointer::operator()(unsigned long sim_time_millis, const Environment& /*env*/)
+{
+	const bool due			 = interval_millis > 0 && sim_time_millis >= next_due;
+	const bool requested_now = requested.exchange(false);
+	if (!due && !requested_now)
+	{
+		return;
+	}
+
+	// Ошибка записи не должна выходить из потока симуляции (std::terminate): считаем её,
+	// запоминаем и пробуем снова в следующий срок. Бросать может только последняя запись в main
+	try
+	{
+		save_checkpoint(simulation, path);
+		++written;
+	}
+	catch (const CheckpointError& error)
+	{
+		const std::scoped_lock lock(error_mutex);
+		++failed;
+		last_error = error.what();
+	}
+	if (due)
+	{
+		next_due = sim_time_millis + interval_millis;
+	}
+}
@@ -0,0 +1,138 @@
+#include "../../includes/simulation/headless.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+BatchReport run_batch(Simulation& simulation, const BatchOptions& options)
+{
+	if (options.step_millis == 0)
+	{
+		throw std::invalid_argument("Batch step must be positive");
+	}
+	if (!(options.duration_seconds >= 0.0 && options.duration_seconds <= MAX_BATCH_SECONDS))
+	{
+		throw std::invalid_argument("Batch duration must be between 0 and 1e12 seconds");
+	}
+
+	const double		MILLIS_IN_SEC = 1000.0;
+	const unsigned long total_millis  = std::llround(options.duration_seconds * MILLIS_IN_SEC);
+	const unsigned long full_ticks	  = total_millis / options.step_millis;
+	const unsigned long remainder	  = total_millis % options.step_millis;
+
+	BatchReport report;
+
+	simulation.set_integrator_settings(options.integrator);
+
+	bool was_running = simulation.state.is_running();
+	simulation.state.set_running(true);
+
+	auto start_time	  = std::chrono::steady_clock::now();
+	auto start_sim_ms = simulation.get_current_time_millis();
+
+	// Интегратор, не справившийся с тиком, отменяет его и останавливает прогон
+	// (см. Simulation::simulate): в отчёт идут только сделанные тики
+	auto tick = [&simulation, &report](unsigned long millis)
+	{
+		simulation.simulate(millis);
+		if (simulation.state.is_running())
+		{
+			++report.ticks;
+		}
+	};
+
+	for (unsigned long done = 0; done < full_ticks && simulation.state.is_running(); ++done)
+	{
+		tick(options.step_millis);
+	}
+
+	if (remainder > 0 && simulation.state.is_running())
+	{
+		tick(remainder);
+	}
+
+	auto end_time = std::chrono::steady_clock::now();
+	simulation.state.set_running(was_running);
+
+	report.simulated_seconds =
+		(double) (simulation.get_current_time_millis() - start_sim_ms) / MILLIS_IN_SEC;
+	report.wall_seconds = std::chrono::duration<double>(end_time - start_time).count();
+
+	return report;
+}
+
+void print_report(std::ostream& out, const Simulation& simulation, const BatchReport& report)
+{
+	Environment env = simulation.state.get_environment();
+
+	out << "simulated_seconds = " << report.simulated_seconds << '\n';
+	out << "wall_seconds = " << report.wall_seconds << '\n';
+	out << "ticks = " << report.ticks << '\n';
+	out << "sim_seconds_per_wall_second = " << report.speedup() << '\n';
+	const auto& integrator = simulation.get_integrator();
+	out << "integrator = " << integrator_name(integrator.get_settings().mode) << '\n';
+	if (integrator.get_settings().mode != IntegratorMode::EULER)
+	{
+		out << "integrator_accepted_steps = " << integrator.get_stats().accepted_steps << '\n';
+		out << "integrator_rejected_steps = " << integrator.get_stats().rejected_steps << '\n';
+		out << "integrator_rhs_evaluations = " << integrator.get_stats().rhs_evaluations << '\n';
+		out << "integrator_failed_ticks = " << integrator.get_stats().failed_ticks << '\n';
+	}
+	if (integrator.get_stats().newton_iterations > 0)
+	{
+		out << "integrator_newton_iterations = " << integrator.get_stats().newton_iterations << '\n';
+		out << "integrator_newton_failures = " << integrator.get_stats().newton_failures << '\n';
+	}
+	out << "status = " << status_name(simulation.state.get_status_mode()) << '\n';
+
+	const auto events = simulation.state.get_alarm_log().recent();
+	if (!events.empty())
+	{
+		out << "\n[alarms]\n";
+		for (const AlarmEvent& event : events)
+		{
+			out << event.sim_time_millis << " ms " << (event.raised ? "raised " : "cleared ")
+				<< status_name(event.severity) << ' ' << event.name << " = " << event.value << '\n';
+		}
+	}
+
+	out << "\n[state]\n";
+	for (const auto& field : ENVIRONMENT_FIELDS)
+	{
+		out << field.name << " = " << env.*field.member << '\n';
+	}
+}
+
+void write_history_csv(std::ostream& out, const History& history)
+{
+	std::vector<History::Series> columns;
+	columns.reserve(ENVIRONMENT_FIELD_COUNT);
+	const unsigned long newest = history.newest_time();
+	for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		columns.push_back(history.range(field, 0, newest));
+	}
+
+	auto precision = out.precision(std::numeric_limits<double>::max_digits10);
+
+	out << "time_ms";
+	for (const auto& field : ENVIRONMENT_FIELDS)
+	{
+		out << ',' << field.name;
+	}
+	out << '\n';
+
+	const auto& times = columns.front().times;
+	for (std::size_t row = 0; row < times.size(); ++row)
+	{
+		out << times[row];
+		for (const auto& column : columns)
+		{
+			out << ',' << column.values[row];
+		}
+		out << '\n';
+	}
+
+	out.precision(precision);
+}
@@ -0,0 +1,870 @@
+#include "../../includes/simulation/integrator.hpp"
+
+#include "../../includes/simulation/thermodynamics.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	using Vector = ReactorOde::Vector;
+
+	constexpr std::size_t TEMPERATURE = ReactorOde::TEMPERATURE;
+	constexpr std::size_t PRESSURE	  = ReactorOde::PRESSURE;
+	constexpr std::size_t HUMIDITY	  = ReactorOde::HUMIDITY;
+	constexpr std::size_t MASS		  = ReactorOde::MASS;
+
+	constexpr double MIN_MASS = 1e-6; // как в update_pressure_with_controller
+
+	// Величины, которые правая часть считает попутно и которые нужны State после шага
+	struct Rates
+	{
+		double heat_capacity;
+		double reaction_heat_rate;
+		double heat_transfer_coefficient;
+		double heating_rate;
+		double cooling_rate;
+	};
+
+	// y + h * sum(a_i * k_i)
+	template <std::size_t STAGES>
+	Vector combine(const Vector& y, double h, const std::array<double, STAGES>& a,
+				   const std::array<Vector, 7>& k)
+	{
+		Vector out = y;
+		for (std::size_t stage = 0; stage < STAGES; ++stage)
+		{
+			if (a[stage] == 0.0)
+			{
+				continue;
+			}
+			for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+			{
+				out[i] += h * a[stage] * k[stage][i];
+			}
+		}
+		return out;
+	}
+
+	// Таблица Бутчера Dormand-Prince 5(4)
+	constexpr std::array<double, 1> A2 = {1.0 / 5.0};
+	constexpr std::array<double, 2> A3 = {3.0 / 40.0, 9.0 / 40.0};
+	constexpr std::array<double, 3> A4 = {44.0 / 45.0, -56.0 / 15.0, 32.0 / 9.0};
+	constexpr std::array<double, 4> A5 = {19372.0 / 6561.0, -25360.0 / 2187.0, 64448.0 / 6561.0,
+										  -212.0 / 729.0};
+	constexpr std::array<double, 5> A6 = {9017.0 / 3168.0, -355.0 / 33.0, 46732.0 / 5247.0,
+										  49.0 / 176.0, -5103.0 / 18656.0};
+	// Решение 5-го порядка (оно же последняя стадия, FSAL)
+	constexpr std::array<double, 6> B = {35.0 / 384.0,	  0.0,			 500.0 / 1113.0,
+										 125.0 / 192.0, -2187.0 / 6784.0, 11.0 / 84.0};
+	// Разность решений 5-го и 4-го порядка - оценка локальной ошибки
+	constexpr std::array<double, 7> E = {71.0 / 57600.0,	 0.0,		   -71.0 / 16695.0,
+										 71.0 / 1920.0,	 -17253.0 / 339200.0, 22.0 / 525.0,
+										 -1.0 / 40.0};
+
+	constexpr double SAFETY			 = 0.9;
+	constexpr double MIN_STEP_FACTOR = 0.2;
+	constexpr double MAX_STEP_FACTOR = 5.0;
+
+	constexpr int MAX_NEWTON_ITERATIONS		= 20;
+	constexpr int MAX_LINE_SEARCH_HALVINGS = 10;
+	// Скользящий режим регулятора температуры: насколько близко (относительно) к уставке
+	// должно быть решение и на каком расстоянии от неё проверяется смена знака невязки
+	constexpr double SLIDING_BAND  = 1e-3;
+	constexpr double SLIDING_PROBE = 1e-9;
+
+	// Максимальное относительное изменение температуры за один неявный шаг
+	constexpr double MAX_RELATIVE_CHANGE = 0.25;
+
+	// Сколько раз за тик неявный шаг может не сойтись и поделиться пополам
+	constexpr unsigned long MAX_FAILURES_PER_TICK = 1000;
+
+	// Гаусс с выбором главного элемента; false, если матрица вырождена
+	bool solve(ReactorOde::Matrix a, Vector& b)
+	{
+		constexpr std::size_t N = ReactorOde::DIMENSION;
+		for (std::size_t column = 0; column < N; ++column)
+		{
+			std::size_t pivot = column;
+			for (std::size_t row = column + 1; row < N; ++row)
+			{
+				if (std::abs(a[row][column]) > std::abs(a[pivot][column]))
+				{
+					pivot = row;
+				}
+			}
+			if (a[pivot][column] == 0.0 || !std::isfinite(a[pivot][column]))
+			{
+				return false;
+			}
+			std::swap(a[pivot], a[column]);
+			std::swap(b[pivot], b[column]);
+
+			for (std::size_t row = column + 1; row < N; ++row)
+			{
+				double factor = a[row][column] / a[column][column];
+				for (std::size_t k = column; k < N; ++k)
+				{
+					a[row][k] -= factor * a[column][k];
+				}
+				b[row] -= factor * b[column];
+			}
+		}
+
+		for (std::size_t row = N; row-- > 0;)
+		{
+			for (std::size_t k = row + 1; k < N; ++k)
+			{
+				b[row] -= a[row][k] * b[k];
+			}
+			b[row] /= a[row][row];
+		}
+		return true;
+	}
+
+	Rates rates_at(const Environment& base, const ControllerGains& gains,
+				   const TemperatureController::FeedForward& feed_forward, const Vector& y,
+				   double& water_flow, double& temperature_rate)
+	{
+		const double temperature = y[TEMPERATURE];
+		const double mass		 = y[MASS];
+
+		Rates rates{};
+		rates.heat_capacity		 = Thermodynamics::calculate_mixture_heat_capacity();
+		rates.reaction_heat_rate = Thermodynamics::calculate_reaction_heat_rate(temperature, mass);
+		rates.heat_transfer_coefficient = Thermodynamics::calculate_heat_transfer_coefficient(
+			base.thermal_conductivity, mass, base.volume, rates.heat_capacity);
+
+		// Влажность: форсунка не может сделать пар больше 100% или меньше 0%
+		double max_water_vapor_mass =
+			Thermodynamics::calculate_max_water_vapor_mass(temperature, base.volume);
+		water_flow = HumidityController::calculate_water_injection_rate(
+			y[HUMIDITY], base.needed_humidity, 1.0, max_water_vapor_mass, gains.humidity_kp);
+		if ((y[HUMIDITY] >= 100.0 && water_flow > 0.0) || (y[HUMIDITY] <= 0.0 && water_flow < 0.0))
+		{
+			water_flow = 0.0;
+		}
+
+		// Температура: регулятор считает компенсацию при нужной температуре
+		const double needed		 = base.needed_temperature;
+		const double loss_needed = feed_forward.loss(rates.heat_transfer_coefficient,
+													 base.surface_area, needed, base.ambient_temperature);
+		const double reac_needed = feed_forward.reaction_heat(mass);
+
+		auto [heating_power, cooling_power] = TemperatureController::calculate_parallel_control_output(
+			needed - temperature, loss_needed, reac_needed, base.max_energy_consumption,
+			gains.temperature_band);
+		rates.heating_rate = heating_power;
+		rates.cooling_rate = cooling_power;
+
+		double loss = Thermodynamics::calculate_conduction_heat_loss(
+						  base.wall_thermal_conductivity, base.surface_area, base.wall_thickness,
+						  temperature, base.ambient_temperature) +
+					  Thermodynamics::calculate_convection_heat_loss(rates.heat_transfer_coefficient,
+																	 base.surface_area, temperature,
+																	 base.ambient_temperature) +
+					  Thermodynamics::calculate_radiation_heat_loss(base.surface_area, temperature,
+																	base.ambient_temperature);
+
+		temperature_rate = Thermodynamics::calculate_temperature_change(
+			mass, rates.heat_capacity,
+			heating_power + rates.reaction_heat_rate +
+				Thermodynamics::calculate_latent_heat_rate(water_flow),
+			loss + cooling_power, 1.0);
+
+		return rates;
+	}
+} // namespace
+
+std::string_view integrator_name(IntegratorMode mode)
+{
+	switch (mode)
+	{
+		case IntegratorMode::EULER:
+			return "euler";
+		case IntegratorMode::DORMAND_PRINCE:
+			return "rk45";
+		case IntegratorMode::BACKWARD_EULER:
+			return "backward-euler";
+		case IntegratorMode::BDF2:
+			return "bdf2";
+	}
+	return "unknown";
+}
+
+IntegratorMode parse_integrator_mode(std::string_view name)
+{
+	for (auto mode : {IntegratorMode::EULER, IntegratorMode::DORMAND_PRINCE,
+					  IntegratorMode::BACKWARD_EULER, IntegratorMode::BDF2})
+	{
+		if (integrator_name(mode) == name)
+		{
+			return mode;
+		}
+	}
+	throw std::invalid_argument("unknown integrator '" + std::string(name) + "'");
+}
+
+Vector ReactorOde::initial_state() const
+{
+	Vector y{};
+	y[TEMPERATURE] = base.temperature;
+	y[HUMIDITY]	   = base.humidity;
+	y[MASS]		   = base.mass;
+	y[PRESSURE]	   = Thermodynamics::calculate_pressure(base.specific_gas_constant, base.volume,
+														base.temperature, base.mass, base.pressure);
+	return y;
+}
+
+double ReactorOde::gas_pressure(const Vector& y) const
+{
+	return Thermodynamics::calculate_pressure(base.specific_gas_constant, base.volume, y[TEMPERATURE],
+											  y[MASS], y[PRESSURE]);
+}
+
+Vector ReactorOde::gas_pressure_gradient(const Vector& y) const
+{
+	Vector gradient{};
+	if (base.specific_gas_constant <= 0.0 || base.volume <= 0.0 || y[TEMPERATURE] <= 0.0)
+	{
+		gradient[PRESSURE] = 1.0; // calculate_pressure возвращает текущее давление
+		return gradient;
+	}
+
+	gradient[TEMPERATURE] = y[MASS] * base.specific_gas_constant / base.volume;
+	gradient[MASS]		  = y[TEMPERATURE] * base.specific_gas_constant / base.volume;
+	return gradient;
+}
+
+Vector ReactorOde::derivative(const Vector& y) const
+{
+	double water_flow		= 0.0;
+	double temperature_rate = 0.0;
+	(void) rates_at(base, gains, feed_forward, y, water_flow, temperature_rate);
+
+	// Регулятор давления отдаёт изменение массы за шаг, при delta_time = 1 это поток в кг/с
+	double pressure_flow = PressureController::calculate_mass_flow_output(
+		base.specific_gas_constant, base.volume, y[TEMPERATURE], y[PRESSURE], base.needed_pressure,
+		y[MASS], 1.0, gains.pressure_kp);
+
+	double max_water_vapor_mass =
+		Thermodynamics::calculate_max_water_vapor_mass(y[TEMPERATURE], base.volume);
+
+	Vector dy{};
+	dy[TEMPERATURE] = temperature_rate;
+	dy[HUMIDITY]	= water_flow / max_water_vapor_mass * 100.0;
+	dy[MASS]		= water_flow + pressure_flow;
+	if (y[MASS] <= MIN_MASS && dy[MASS] < 0.0)
+	{
+		dy[MASS] = 0.0; // масса уже на нижней границе, как в update_pressure_with_controller
+	}
+
+	// p = m*R*T/V  =>  dp/dt = R/V * (T*dm/dt + m*dT/dt)
+	if (base.specific_gas_constant > 0.0 && base.volume > 0.0 && y[TEMPERATURE] > 0.0)
+	{
+		dy[PRESSURE] = base.specific_gas_constant / base.volume *
+					   ((y[TEMPERATURE] * dy[MASS]) + (y[MASS] * dy[TEMPERATURE]));
+	}
+	return dy;
+}
+
+ReactorOde::Matrix ReactorOde::jacobian(const Vector& y) const
+{
+	const double temperature = y[TEMPERATURE];
+	const double pressure	 = y[PRESSURE];
+	const double humidity	 = y[HUMIDITY];
+	const double mass		 = y[MASS];
+	const double area		 = base.surface_area;
+	const double ambient	 = base.ambient_temperature;
+
+	Matrix j{};
+
+	const double heat_capacity = Thermodynamics::calculate_mixture_heat_capacity();
+	const double htc		   = Thermodynamics::calculate_heat_transfer_coefficient(
+		  base.thermal_conductivity, mass, base.volume, heat_capacity);
+	const double htc_dm = Thermodynamics::calculate_heat_transfer_coefficient_mass_derivative(htc, mass);
+
+	// Влажность. Вне насыщения форсунки поток (hn - h) * kp / 100 * m_max(T)
+	const double max_water = Thermodynamics::calculate_max_water_vapor_mass(temperature, base.volume);
+	const double max_water_dt =
+		Thermodynamics::calculate_max_water_vapor_mass_derivative(temperature, base.volume);
+	const double raw_flow = (((base.needed_humidity - humidity) * gains.humidity_kp) / 100.0) * max_water;
+	double		 water_flow = HumidityController::calculate_water_injection_rate(
+		  humidity, base.needed_humidity, 1.0, max_water, gains.humidity_kp);
+	double water_flow_dh = 0.0;
+	double water_flow_dt = 0.0;
+	if ((humidity >= 100.0 && water_flow > 0.0) || (humidity <= 0.0 && water_flow < 0.0))
+	{
+		water_flow = 0.0;
+	}
+	else if (std::abs(water_flow) >= std::abs(raw_flow))
+	{
+		water_flow_dh = -gains.humidity_kp / 100.0 * max_water;
+		water_flow_dt = raw_flow / max_water * max_water_dt;
+	}
+
+	j[HUMIDITY][HUMIDITY]	 = 100.0 * water_flow_dh / max_water;
+	j[HUMIDITY][TEMPERATURE] = 100.0 * ((water_flow_dt * max_water) - (water_flow * max_water_dt)) /
+							   (max_water * max_water);
+
+	// Регулятор температуры: d(heating - cooling) по T и по m (через компенсацию потерь)
+	const double needed			= base.needed_temperature;
+	const double max_power		= base.max_energy_consumption;
+	const double controller_kp	= max_power / gains.temperature_band;
+	const double loss_needed	= feed_forward.loss(htc, area, needed, ambient);
+	const double loss_needed_dm	= area * (needed - ambient) * htc_dm;
+	const double reac_needed	= feed_forward.reaction_heat(mass);
+	const double reac_needed_dm	= mass > 0.0 ? reac_needed / mass : 0.0;
+
+	auto [heating_power, cooling_power] = TemperatureController::calculate_parallel_control_output(
+		needed - temperature, loss_needed, reac_needed, max_power, gains.temperature_band);
+
+	double control_dt = 0.0;
+	double control_dm = 0.0;
+	const double diff = needed - temperature;
+	if (diff >= 0)
+	{
+		double raw = std::max(0.0, loss_needed - reac_needed) + (controller_kp * diff);
+		if (raw > 0.0 && raw < max_power)
+		{
+			control_dt = -controller_kp;
+			control_dm = loss_needed > reac_needed ? loss_needed_dm - reac_needed_dm : 0.0;
+		}
+	}
+	else
+	{
+		double raw = std::max(0.0, reac_needed - loss_needed) - (controller_kp * diff);
+		if (raw > 0.0 && raw < max_power)
+		{
+			control_dt = -controller_kp;
+			control_dm = reac_needed > loss_needed ? loss_needed_dm - reac_needed_dm : 0.0;
+		}
+	}
+
+	// Тепловой баланс net = heating - cooling + reaction + latent - loss, dT/dt = net / (m * c)
+	const double reaction = Thermodynamics::calculate_reaction_heat_rate(temperature, mass);
+	const double loss =
+		Thermodynamics::calculate_conduction_heat_loss(base.wall_thermal_conductivity, area,
+													   base.wall_thickness, temperature, ambient) +
+		Thermodynamics::calculate_convection_heat_loss(htc, area, temperature, ambient) +
+		Thermodynamics::calculate_radiation_heat_loss(area, temperature, ambient);
+	const double loss_dt = Thermodynamics::calculate_conduction_heat_loss_derivative(
+							   base.wall_thermal_conductivity, area, base.wall_thickness) +
+						   Thermodynamics::calculate_convection_heat_loss_derivative(htc, area) +
+						   Thermodynamics::calculate_radiation_heat_loss_derivative(area, temperature);
+
+	const double net = heating_power - cooling_power + reaction +
+					   Thermodynamics::calculate_latent_heat_rate(water_flow) - loss;
+	const double net_dt = control_dt +
+						  Thermodynamics::calculate_reaction_heat_rate_derivative(temperature, mass) +
+						  Thermodynamics::calculate_latent_heat_rate(water_flow_dt) - loss_dt;
+	const double net_dh = Thermodynamics::calculate_latent_heat_rate(water_flow_dh);
+	const double net_dm =
+		control_dm + (mass > 0.0 ? reaction / mass : 0.0) - (area * (temperature - ambient) * htc_dm);
+
+	double temperature_rate = 0.0;
+	if (mass > 0.0 && heat_capacity > 0.0)
+	{
+		const double thermal_mass = mass * heat_capacity;
+		temperature_rate		  = net / thermal_mass;
+
+		j[TEMPERATURE][TEMPERATURE] = net_dt / thermal_mass;
+		j[TEMPERATURE][HUMIDITY]	= net_dh / thermal_mass;
+		j[TEMPERATURE][MASS]		= (net_dm / thermal_mass) - (temperature_rate / mass);
+	}
+
+	// Масса: вода + регулятор давления. Вне ограничения поток kp * (pn - p) * V / (R * T),
+	// на ограничении +-доля массы в секунду
+	const double gas_const = base.specific_gas_constant;
+	const double volume	   = base.volume;
+	if (gas_const <= 0.0 || volume <= 0.0 || temperature <= 0.0)
+	{
+		j[MASS][TEMPERATURE] = water_flow_dt;
+		j[MASS][HUMIDITY]	 = water_flow_dh;
+		return j;
+	}
+
+	const double raw_pressure_flow =
+		gains.pressure_kp * (base.needed_pressure - pressure) * volume / (gas_const * temperature);
+	const double pressure_flow = PressureController::calculate_mass_flow_output(
+		gas_const, volume, temperature, pressure, base.needed_pressure, mass, 1.0, gains.pressure_kp);
+	double pressure_flow_dp = 0.0;
+	double pressure_flow_dt = 0.0;
+	double pressure_flow_dm = 0.0;
+	if (std::abs(pressure_flow) >= std::abs(raw_pressure_flow))
+	{
+		pressure_flow_dp = -gains.pressure_kp * volume / (gas_const * temperature);
+		pressure_flow_dt = -raw_pressure_flow / temperature;
+	}
+	else
+	{
+		pressure_flow_dm = pressure_flow / mass;
+	}
+
+	double mass_rate = water_flow + pressure_flow;
+	if (mass <= MIN_MASS && mass_rate < 0.0)
+	{
+		mass_rate = 0.0;
+	}
+	else
+	{
+		j[MASS][TEMPERATURE] = water_flow_dt + pressure_flow_dt;
+		j[MASS][PRESSURE]	 = pressure_flow_dp;
+		j[MASS][HUMIDITY]	 = water_flow_dh;
+		j[MASS][MASS]		 = pressure_flow_dm;
+	}
+
+	// dp/dt = R/V * (T * dm/dt + m * dT/dt)
+	for (std::size_t column = 0; column < DIMENSION; ++column)
+	{
+		j[PRESSURE][column] = gas_const / volume *
+							  ((temperature * j[MASS][column]) + (mass * j[TEMPERATURE][column]));
+	}
+	j[PRESSURE][TEMPERATURE] += gas_const / volume * mass_rate;
+	j[PRESSURE][MASS] += gas_const / volume * temperature_rate;
+
+	return j;
+}
+
+void ReactorOde::clamp(Vector& y)
+{
+	y[HUMIDITY] = std::clamp(y[HUMIDITY], 0.0, 100.0);
+	y[MASS]		= std::max(y[MASS], MIN_MASS);
+}
+
+void ReactorOde::store(const Vector& y, Environment& env) const
+{
+	double water_flow		= 0.0;
+	double temperature_rate = 0.0;
+	Rates  rates			= rates_at(base, gains, feed_forward, y, water_flow, temperature_rate);
+
+	env.temperature				  = y[TEMPERATURE];
+	env.humidity				  = y[HUMIDITY];
+	env.mass					  = y[MASS];
+	env.pressure				  = Thermodynamics::calculate_pressure(
+		   base.specific_gas_constant, base.volume, y[TEMPERATURE], y[MASS], y[PRESSURE]);
+	env.heat_capacity			  = rates.heat_capacity;
+	env.reaction_heat_rate		  = rates.reaction_heat_rate;
+	env.heat_transfer_coefficient = rates.heat_transfer_coefficient;
+	env.heating_rate			  = rates.heating_rate;
+	env.cooling_rate			  = rates.cooling_rate;
+}
+
+bool Integrator::dormand_prince(const ReactorOde& ode, Vector& y, double duration)
+{
+	const double max_step = settings.max_step > 0.0 ? settings.max_step : duration;
+	double		 h		  = step_hint > 0.0 ? step_hint : duration;
+	h					  = std::clamp(h, std::min(settings.min_step, duration), max_step);
+
+	std::array<Vector, 7> k{};
+	k[0] = ode.derivative(y);
+	++stats.rhs_evaluations;
+
+	double elapsed = 0.0;
+	while (elapsed < duration)
+	{
+		// Последний подшаг укорачиваем до конца тика, но подсказку на следующий тик не портим
+		const double remaining = duration - elapsed;
+		const bool	 last	   = h >= remaining;
+		const double step	   = last ? remaining : h;
+
+		k[1] = ode.derivative(combine(y, step, A2, k));
+		k[2] = ode.derivative(combine(y, step, A3, k));
+		k[3] = ode.derivative(combine(y, step, A4, k));
+		k[4] = ode.derivative(combine(y, step, A5, k));
+		k[5] = ode.derivative(combine(y, step, A6, k));
+		Vector next = combine(y, step, B, k);
+		k[6]		= ode.derivative(next);
+		stats.rhs_evaluations += 6;
+
+		// Взвешенная RMS-норма ошибки: <= 1 означает, что допуски соблюдены
+		double error = 0.0;
+		for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+		{
+			double local = 0.0;
+			for (std::size_t stage = 0; stage < E.size(); ++stage)
+			{
+				local += E[stage] * k[stage][i];
+			}
+			local *= step;
+
+			double scale = settings.absolute_tolerance +
+						   (settings.relative_tolerance * std::max(std::abs(y[i]), std::abs(next[i])));
+			error += (local / scale) * (local / scale);
+		}
+		error = std::sqrt(error / ReactorOde::DIMENSION);
+
+		// NaN или бесконечность в стадиях: шаг отвергается сразу до min_step, а если и там
+		// оценка не конечна - решение ушло из области модели, тик не делается
+		if (!std::isfinite(error))
+		{
+			++stats.rejected_steps;
+			if (step <= settings.min_step)
+			{
+				step_hint = 0.0;
+				++stats.failed_ticks;
+				return false;
+			}
+			h = settings.min_step;
+			continue;
+		}
+
+		double factor = error > 0.0 ? SAFETY * std::pow(error, -0.2) : MAX_STEP_FACTOR;
+		factor		  = std::clamp(factor, MIN_STEP_FACTOR, MAX_STEP_FACTOR);
+
+		if (error <= 1.0 || step <= settings.min_step)
+		{
+			// FSAL: последняя стадия принятого шага - первая стадия следующего,
+			// если ограничения не сдвинули решение
+			Vector unclamped = next;
+			ReactorOde::clamp(next);
+			if (next == unclamped)
+			{
+				k[0] = k[6];
+			}
+			else
+			{
+				k[0] = ode.derivative(next);
+				++stats.rhs_evaluations;
+			}
+
+			y = next;
+			elapsed += step;
+			++stats.accepted_steps;
+
+			if (!last || factor < 1.0)
+			{
+				h = std::clamp(step * factor, settings.min_step, max_step);
+			}
+		}
+		else
+		{
+			++stats.rejected_steps;
+			h = std::max(step * factor, settings.min_step);
+		}
+	}
+
+	step_hint = h;
+	return true;
+}
+
+bool Integrator::newton_iterate(const ReactorOde& ode, Vector& y, const Vector& constant, double gamma,
+							   bool sliding)
+{
+	auto norm = [&](const Vector& v, const Vector& reference)
+	{
+		double sum = 0.0;
+		for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+		{
+			double scale =
+				settings.absolute_tolerance + (settings.relative_tolerance * std::abs(reference[i]));
+			sum += (v[i] / scale) * (v[i] / scale);
+		}
+		return std::sqrt(sum / ReactorOde::DIMENSION);
+	};
+
+	auto residual = [&](const Vector& x, Vector& g)
+	{
+		if (!(x[TEMPERATURE] > 0.0) || !(x[PRESSURE] > 0.0))
+		{
+			return std::numeric_limits<double>::infinity();
+		}
+
+		++stats.rhs_evaluations;
+		Vector f = ode.derivative(x);
+		for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+		{
+			g[i] = x[i] - constant[i] - (gamma * f[i]);
+		}
+		g[PRESSURE] = x[PRESSURE] - ode.gas_pressure(x);
+		if (sliding)
+		{
+			g[TEMPERATURE] = 0.0;
+		}
+		return norm(g, constant);
+	};
+
+	Vector g{};
+	double g_norm = residual(y, g);
+	if (!std::isfinite(g_norm))
+	{
+		return false;
+	}
+
+	// Сходимость - по величине поправки Ньютона, и хотя бы одна поправка делается всегда.
+	// Невязка G = y - c - h*f мала уже у начального приближения, когда мала h*f (почти
+	// установившийся режим): проверка невязки против допуска состояния принимала бы y_n как
+	// y_{n+1}, и медленные члены (подкачка массы регулятором давления) не двигались бы вовсе
+	for (int iteration = 0; iteration < MAX_NEWTON_ITERATIONS; ++iteration)
+	{
+		++stats.newton_iterations;
+
+		ReactorOde::Matrix a		= ode.jacobian(y);
+		Vector			   pressure = ode.gas_pressure_gradient(y);
+		Vector			   delta{};
+		for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+		{
+			delta[i] = -g[i];
+			for (std::size_t k = 0; k < ReactorOde::DIMENSION; ++k)
+			{
+				double identity = i == k ? 1.0 : 0.0;
+				if (i == PRESSURE)
+				{
+					a[i][k] = identity - pressure[k];
+				}
+				else if (i == TEMPERATURE && sliding)
+				{
+					a[i][k] = identity;
+				}
+				else
+				{
+					a[i][k] = identity - (gamma * a[i][k]);
+				}
+			}
+		}
+		if (!solve(a, delta))
+		{
+			return false;
+		}
+
+		// Поправка в пределах допуска: берём её целиком. Невязка здесь на уровне округления,
+		// и дробление ниже могло бы не найти её уменьшения
+		if (norm(delta, y) <= 1.0)
+		{
+			for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+			{
+				y[i] += delta[i];
+			}
+			ReactorOde::clamp(y);
+			return true;
+		}
+
+		// Дробление шага, пока невязка не уменьшится
+		double lambda = 1.0;
+		Vector trial{};
+		Vector trial_g{};
+		double trial_norm = 0.0;
+		for (int halving = 0;; ++halving)
+		{
+			for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+			{
+				trial[i] = y[i] + (lambda * delta[i]);
+			}
+			ReactorOde::clamp(trial);
+			trial_norm = residual(trial, trial_g);
+
+			if (trial_norm < g_norm)
+			{
+				break;
+			}
+			if (halving == MAX_LINE_SEARCH_HALVINGS)
+			{
+				return false;
+			}
+			lambda /= 2.0;
+		}
+
+		Vector change{};
+		for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+		{
+			change[i] = trial[i] - y[i];
+		}
+
+		y	   = trial;
+		g	   = trial_g;
+		g_norm = trial_norm;
+
+		if (norm(change, y) <= 1.0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Integrator::newton(const ReactorOde& ode, Vector& y, const Vector& constant, double gamma)
+{
+	// Решаем G(y) = y - constant - gamma * f(y) = 0 методом Ньютона с дроблением шага:
+	// правая часть кусочно-гладкая (насыщение регуляторов), и без дробления итерации
+	// зацикливаются или уходят в нефизичные корни (отрицательные температура и давление).
+	// Строка давления заменена уравнением состояния p - m*R*T/V = 0.
+	//
+	// У регулятора температуры разрыв при T = T_нужн: компенсация потерь включена только
+	// на стороне нагрева. Когда решение прижато к уставке (скользящий режим), уравнение
+	// температуры корня не имеет, G_T лишь меняет знак на уставке. Тогда фиксируем
+	// T = T_нужн и решаем остальные уравнения.
+	const double needed = ode.needed_temperature();
+
+	auto near_setpoint = [&](const Vector& x)
+	{ return std::abs(x[TEMPERATURE] - needed) <= SLIDING_BAND * needed; };
+
+	auto try_sliding = [&](Vector& x)
+	{
+		Vector candidate	   = x;
+		candidate[TEMPERATURE] = needed;
+		if (!newton_iterate(ode, candidate, constant, gamma, true))
+		{
+			return false;
+		}
+
+		// G_T должна менять знак при переходе через уставку
+		Vector below = candidate;
+		Vector above = candidate;
+		below[TEMPERATURE] = needed * (1.0 - SLIDING_PROBE);
+		above[TEMPERATURE] = needed * (1.0 + SLIDING_PROBE);
+		stats.rhs_evaluations += 2;
+		double g_below = below[TEMPERATURE] - constant[TEMPERATURE] -
+						 (gamma * ode.derivative(below)[TEMPERATURE]);
+		double g_above = above[TEMPERATURE] - constant[TEMPERATURE] -
+						 (gamma * ode.derivative(above)[TEMPERATURE]);
+		if (!(g_below < 0.0 && g_above > 0.0))
+		{
+			return false;
+		}
+
+		x = candidate;
+		return true;
+	};
+
+	if (near_setpoint(y) && try_sliding(y))
+	{
+		return true;
+	}
+
+	Vector start = y;
+	if (newton_iterate(ode, y, constant, gamma, false))
+	{
+		return true;
+	}
+	if (near_setpoint(y) && try_sliding(y))
+	{
+		return true;
+	}
+
+	y = start;
+	return false;
+}
+
+bool Integrator::implicit_step(const ReactorOde& ode, Vector& y, double step)
+{
+	Vector constant = y;
+	Vector guess	= y;
+	double gamma	= step;
+
+	if (settings.mode == IntegratorMode::BDF2 && has_history)
+	{
+		// BDF2 с переменным шагом, omega = h_n / h_{n-1}:
+		// y+ - (1+w)^2/(1+2w) y_n + w^2/(1+2w) y_{n-1} = h (1+w)/(1+2w) f(y+)
+		const double omega = step / previous_step;
+		const double denom = 1.0 + (2.0 * omega);
+		for (std::size_t i = 0; i < ReactorOde::DIMENSION; ++i)
+		{
+			constant[i] = ((1.0 + omega) * (1.0 + omega) / denom * y[i]) -
+						  (omega * omega / denom * previous[i]);
+			guess[i]	= y[i] + (omega * (y[i] - previous[i]));
+		}
+		gamma = step * (1.0 + omega) / denom;
+	}
+
+	// Доверительная область: у неявных уравнений бывает несколько корней (например, при
+	// большом шаге - "горячий" корень, где конденсация греет реактор сильнее, чем отводит
+	// регулятор). Корень, в котором T меняется за шаг больше чем на MAX_RELATIVE_CHANGE,
+	// считаем чужим и делим шаг.
+	auto within_trust_region = [&](const Vector& next)
+	{ return std::abs(next[TEMPERATURE] - y[TEMPERATURE]) <= MAX_RELATIVE_CHANGE * y[TEMPERATURE]; };
+
+	Vector next = guess;
+	if (!newton(ode, next, constant, gamma) || !within_trust_region(next))
+	{
+		++stats.newton_failures;
+		if (step / 2.0 < settings.min_step || failures_left == 0)
+		{
+			return false;
+		}
+		--failures_left;
+
+		// Делим шаг пополам, после деления стартуем заново с неявного Эйлера
+		has_history = false;
+		return implicit_step(ode, y, step / 2.0) && implicit_step(ode, y, step / 2.0);
+	}
+
+	ReactorOde::clamp(next);
+	previous	  = y;
+	previous_step = step;
+	has_history	  = true;
+	y			  = next;
+	++stats.accepted_steps;
+	return true;
+}
+
+bool Integrator::implicit(const ReactorOde& ode, Vector& y, double duration)
+{
+	// Давление при старте тика пересчитывается по уравнению состояния, сравниваем остальное
+	if (has_history && (y[TEMPERATURE] != last_output[TEMPERATURE] ||
+						y[HUMIDITY] != last_output[HUMIDITY] || y[MASS] != last_output[MASS]))
+	{
+		has_history = false;
+	}
+
+	// Фиксированный шаг: весь тик или равные части не длиннее max_step
+	std::size_t substeps = 1;
+	if (settings.max_step > 0.0 && duration > settings.max_step)
+	{
+		substeps = static_cast<std::size_t>(std::ceil(duration / settings.max_step));
+	}
+	const double step = duration / static_cast<double>(substeps);
+
+	// Деление пополам рекурсивное: вне области модели (масса выкипела, T уходит вразнос)
+	// дерево подшагов растёт экспоненциально, поэтому число неудач на тик ограничено
+	failures_left = MAX_FAILURES_PER_TICK;
+	for (std::size_t i = 0; i < substeps; ++i)
+	{
+		if (!implicit_step(ode, y, step))
+		{
+			// История указывает на отброшенные подшаги: следующий тик начнёт с неявного Эйлера
+			has_history = false;
+			++stats.failed_ticks;
+			return false;
+		}
+	}
+
+	last_output = y;
+	return true;
+}
+
+bool Integrator::advance(Environment& env, const ControllerGains& gains, double duration)
+{
+	if (duration <= 0.0)
+	{
+		return true;
+	}
+
+	ReactorOde ode(env, gains, feed_forward.get(ReactorOde::feed_forward_inputs(env)));
+	Vector	   y = ode.initial_state();
+
+	switch (settings.mode)
+	{
+		case IntegratorMode::DORMAND_PRINCE:
+			if (!dormand_prince(ode, y, duration))
+			{
+				return false;
+			}
+			break;
+		case IntegratorMode::BACKWARD_EULER:
+		case IntegratorMode::BDF2:
+			if (!implicit(ode, y, duration))
+			{
+				return false;
+			}
+			break;
+		case IntegratorMode::EULER:
+			throw std::logic_error("Euler steps are done by Simulation::simulate");
+	}
+
+	ode.store(y, env);
+	return true;
+}
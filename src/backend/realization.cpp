@@ -27,17 +27,45 @@ std::shared_ptr<Simulation>
 
 void Simulation::operator()()
 {
-	for (; !state.is_terminated();)
+	using Clock = std::chrono::steady_clock;
+	const auto TICK = std::chrono::milliseconds(TIME_OF_TICK);
+
+	state.get_profile().set_enabled(true);
+	Tracer::set_thread_name("simulation");
+
+	while (state.wait_until_running())
 	{
-		auto previous_time = std::chrono::high_resolution_clock::now();
-		while (state.is_running())
+		// Абсолютные дедлайны: опоздание одного тика не сдвигает следующие.
+		// Прошедшее время считается в наносекундах, в simulate уходят целые миллисекунды,
+		// остаток переносится на следующий тик, поэтому время симуляции не отстаёт от часов
+		auto previous = Clock::now();
+		auto deadline = previous;
+		auto pending  = std::chrono::nanoseconds::zero();
+
+		while (true)
 		{
-			std::this_thread::sleep_for(std::chrono::milliseconds(TIME_OF_TICK));
-			auto current_time = std::chrono::high_resolution_clock::now();
-			auto duration =
-				std::chrono::duration_cast<std::chrono::milliseconds>(current_time - previous_time);
-			simulate(duration.count());
-			previous_time = current_time;
+			deadline += TICK;
+			if (!state.sleep_until(deadline))
+			{
+				break;
+			}
+
+			auto now = Clock::now();
+			// Опоздание пробуждения относительно дедлайна (без REACTOR_PROFILING - пустой вызов)
+			state.get_profile().record(ProfileStage::JITTER, now - deadline);
+			pending += now - previous;
+			previous = now;
+
+			auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(pending);
+			pending -= elapsed;
+			simulate(elapsed.count());
+
+			// Отстали больше чем на тик (медленный шаг, спящий хост) - не догоняем пачкой
+			// коротких тиков, а продолжаем от текущего момента
+			if (now - deadline > TICK)
+			{
+				deadline = now;
+			}
 		}
 	}
 }
@@ -0,0 +1,409 @@
+#include "../../includes/simulation/stream.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+namespace
+{
+	constexpr std::array<char, 8> BINARY_MAGIC{'R', 'C', 'T', 'S', 'T', 'R', '0', '1'};
+	constexpr std::size_t		  BINARY_NAME_LENGTH = 32;
+
+	// Заголовок бинарного потока; за ним field_count имён по BINARY_NAME_LENGTH байт (с нулями),
+	// затем записи по record_bytes: время (uint64, мс) и поля Environment (double).
+	// Порядок байт - как у машины, которая пишет
+	struct BinaryHeader
+	{
+		std::array<char, 8> magic;
+		std::uint32_t		field_count;
+		std::uint32_t		record_bytes;
+	};
+
+	constexpr std::size_t BINARY_RECORD_BYTES =
+		sizeof(std::uint64_t) + (ENVIRONMENT_FIELD_COUNT * sizeof(double));
+
+	// Самое длинное число из std::to_chars: "-1.2345678901234567e-308"
+	constexpr std::size_t NUMBER_LENGTH = 32;
+
+	void append_number(std::string& buffer, double value)
+	{
+		std::array<char, NUMBER_LENGTH> digits{};
+		const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+		buffer.append(digits.data(), result.ptr);
+	}
+
+	void append_number(std::string& buffer, unsigned long value)
+	{
+		std::array<char, NUMBER_LENGTH> digits{};
+		const auto result = std::to_chars(digits.data(), digits.data() + digits.size(), value);
+		buffer.append(digits.data(), result.ptr);
+	}
+
+	// Файл или стандартный вывод; пачка записей уходит одним write
+	class OstreamSink : public StreamSink
+	{
+		std::ofstream file;
+		std::ostream* out;
+		std::string	  path;
+
+	protected:
+		std::string buffer; // переиспользуется между пачками
+
+		void emit(const char* data, std::size_t size)
+		{
+			out->write(data, static_cast<std::streamsize>(size));
+			if (!*out)
+			{
+				throw StreamError("stream: failed to write '" + path + "'");
+			}
+		}
+
+		void emit_buffer()
+		{
+			emit(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+
+	public:
+		explicit OstreamSink(const StreamSpec& spec, std::ios::openmode mode = std::ios::out)
+			: out(&std::cout), path(spec.path)
+		{
+			if (!spec.is_stdout())
+			{
+				file.open(spec.path, mode | std::ios::trunc);
+				if (!file.is_open())
+				{
+					throw StreamError("stream: failed to open '" + spec.path + "'");
+				}
+				out = &file;
+			}
+		}
+
+		void flush() override
+		{
+			out->flush();
+			if (!*out)
+			{
+				throw StreamError("stream: failed to flush '" + path + "'");
+			}
+		}
+	};
+
+	class CsvStreamSink : public OstreamSink
+	{
+	public:
+		explicit CsvStreamSink(const StreamSpec& spec) : OstreamSink(spec)
+		{
+			buffer = "time_ms";
+			for (const auto& field : ENVIRONMENT_FIELDS)
+			{
+				buffer += ',';
+				buffer += field.name;
+			}
+			buffer += '\n';
+			emit_buffer();
+		}
+
+		void write(std::span<const StreamRecord> records) override
+		{
+			for (const StreamRecord& record : records)
+			{
+				append_number(buffer, record.sim_time_millis);
+				for (const auto& field : ENVIRONMENT_FIELDS)
+				{
+					buffer += ',';
+					append_number(buffer, record.environment.*field.member);
+				}
+				buffer += '\n';
+			}
+			emit_buffer();
+		}
+	};
+
+	class NdjsonStreamSink : public OstreamSink
+	{
+	public:
+		using OstreamSink::OstreamSink;
+
+		void write(std::span<const StreamRecord> records) override
+		{
+			for (const StreamRecord& record : records)
+			{
+				buffer += "{\"time_ms\":";
+				append_number(buffer, record.sim_time_millis);
+				for (const auto& field : ENVIRONMENT_FIELDS)
+				{
+					buffer += ",\"";
+					buffer += field.name;
+					buffer += "\":";
+					// В JSON нет NaN и бесконечностей
+					const double value = record.environment.*field.member;
+					if (std::isfinite(value))
+					{
+						append_number(buffer, value);
+					}
+					else
+					{
+						buffer += "null";
+					}
+				}
+				buffer += "}\n";
+			}
+			emit_buffer();
+		}
+	};
+
+	class BinaryStreamSink : public OstreamSink
+	{
+	public:
+		explicit BinaryStreamSink(const StreamSpec& spec) : OstreamSink(spec, std::ios::binary)
+		{
+			const BinaryHeader header{.magic		= BINARY_MAGIC,
+									  .field_count	= ENVIRONMENT_FIELD_COUNT,
+									  .record_bytes = BINARY_RECORD_BYTES};
+			buffer.append(reinterpret_cast<const char*>(&header), sizeof(header)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+			for (const auto& field : ENVIRONMENT_FIELDS)
+			{
+				std::array<char, BINARY_NAME_LENGTH> name{};
+				std::memcpy(name.data(), field.name.data(),
+							std::min(field.name.size(), BINARY_NAME_LENGTH - 1));
+				buffer.append(name.data(), name.size());
+			}
+			emit_buffer();
+		}
+
+		void write(std::span<const StreamRecord> records) override
+		{
+			buffer.resize(records.size() * BINARY_RECORD_BYTES);
+			char* row = buffer.data();
+			for (const StreamRecord& record : records)
+			{
+				const std::uint64_t time = record.sim_time_millis;
+				std::memcpy(row, &time, sizeof(time));
+				row += sizeof(time);
+				for (const auto& field : ENVIRONMENT_FIELDS)
+				{
+					const double value = record.environment.*field.member;
+					std::memcpy(row, &value, sizeof(value));
+					row += sizeof(value);
+				}
+			}
+			emit_buffer();
+		}
+	};
+} // namespace
+
+StreamSpec parse_stream_spec(std::string_view text)
+{
+	const auto colon = text.find(':');
+	if (colon == std::string_view::npos || colon + 1 == text.size())
+	{
+		throw std::invalid_argument("stream must be <format>:<path>, got '" + std::string(text) +
+									"'");
+	}
+
+	StreamSpec spec{.format = StreamFormat::CSV, .path = std::string(text.substr(colon + 1))};
+
+	const std::string_view format = text.substr(0, colon);
+	if (format == "csv")
+	{
+		spec.format = StreamFormat::CSV;
+	}
+	else if (format == "ndjson")
+	{
+		spec.format = StreamFormat::NDJSON;
+	}
+	else if (format == "binary")
+	{
+		spec.format = StreamFormat::BINARY;
+	}
+	else
+	{
+		throw std::invalid_argument("unknown stream format '" + std::string(format) +
+									"' (csv, ndjson, binary)");
+	}
+	return spec;
+}
+
+std::unique_ptr<StreamSink> make_stream_sink(const StreamSpec& spec)
+{
+	switch (spec.format)
+	{
+	case StreamFormat::NDJSON:
+		return std::make_unique<NdjsonStreamSink>(spec);
+	case StreamFormat::BINARY:
+		return std::make_unique<BinaryStreamSink>(spec);
+	case StreamFormat::CSV:
+		break;
+	}
+	return std::make_unique<CsvStreamSink>(spec);
+}
+
+StreamWriter::StreamWriter(std::vector<std::unique_ptr<StreamSink>> sinks, std::size_t capacity,
+						   StreamPolicy policy)
+	: sinks(std::move(sinks)), policy(policy), ring(std::max<std::size_t>(capacity, 1))
+{
+	worker = std::thread(&StreamWriter::run, this);
+}
+
+StreamWriter::~StreamWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (const std::exception&) // NOLINT(bugprone-empty-catch)
+	{
+		// Из деструктора не бросаем; ошибку видит тот, кто зовёт close()
+	}
+}
+
+void StreamWriter::push(unsigned long sim_time_millis, const Environment& env)
+{
+	std::unique_lock lock(mutex);
+	if (failed || closing)
+	{
+		++stats.dropped;
+		return;
+	}
+
+	if (policy == StreamPolicy::DECIMATE)
+	{
+		if (phase + 1 < stride)
+		{
+			++phase;
+			++stats.decimated;
+			return;
+		}
+		phase = 0;
+	}
+
+	if (count == ring.size())
+	{
+		switch (policy)
+		{
+		case StreamPolicy::BLOCK:
+			not_full.wait(lock, [this] { return count < ring.size() || failed; });
+			if (failed)
+			{
+				++stats.dropped;
+				return;
+			}
+			break;
+		case StreamPolicy::DROP_OLDEST:
+			head = (head + 1) % ring.size();
+			--count;
+			++stats.dropped;
+			break;
+		case StreamPolicy::DECIMATE:
+			// Очередь уже прорежена с текущим шагом: реже берём следующие записи
+			stride = std::min(stride * 2, MAX_STRIDE);
+			++stats.decimated;
+			return;
+		}
+	}
+
+	const bool was_empty = count == 0;
+
+	ring[(head + count) % ring.size()] = {.sim_time_millis = sim_time_millis, .environment = env};
+	++count;
+	lock.unlock();
+
+	// Писатель спит только на пустой очереди: будить его на каждой записи незачем
+	if (was_empty)
+	{
+		not_empty.notify_one();
+	}
+}
+
+void StreamWriter::run()
+{
+	std::vector<StreamRecord> batch;
+	batch.reserve(ring.size());
+
+	try
+	{
+		while (true)
+		{
+			{
+				std::unique_lock lock(mutex);
+				not_empty.wait(lock, [this] { return count > 0 || closing; });
+				if (count == 0)
+				{
+					break;
+				}
+
+				const std::size_t first = std::min(count, ring.size() - head);
+				batch.insert(batch.end(), ring.begin() + static_cast<std::ptrdiff_t>(head),
+							 ring.begin() + static_cast<std::ptrdiff_t>(head + first));
+				batch.insert(batch.end(), ring.begin(),
+							 ring.begin() + static_cast<std::ptrdiff_t>(count - first));
+				head  = 0;
+				count = 0;
+
+				// Писатель догнал: забранная пачка меньше четверти очереди - прореживаем реже
+				if (stride > 1 && batch.size() < ring.size() / 4)
+				{
+					stride /= 2;
+				}
+			}
+			not_full.notify_all();
+
+			for (const auto& sink : sinks)
+			{
+				sink->write(batch);
+				sink->flush();
+			}
+
+			{
+				std::scoped_lock lock(mutex);
+				stats.written += batch.size();
+			}
+			batch.clear();
+		}
+	}
+	catch (const std::exception&)
+	{
+		std::scoped_lock lock(mutex);
+		error  = std::current_exception();
+		failed = true;
+		stats.dropped += count + batch.size(); // недописанная пачка тоже потеряна
+		count = 0;
+	}
+	not_full.notify_all();
+}
+
+void StreamWriter::close()
+{
+	{
+		std::scoped_lock lock(mutex);
+		closing = true;
+	}
+	not_empty.notify_one();
+
+	if (worker.joinable())
+	{
+		worker.join();
+	}
+
+	std::exception_ptr pending;
+	{
+		std::scoped_lock lock(mutex);
+		pending = std::exchange(error, nullptr);
+	}
+	if (pending)
+	{
+		std::rethrow_exception(pending);
+	}
+}
+
+StreamWriter::Stats StreamWriter::get_stats() const
+{
+	std::scoped_lock lock(mutex);
+	return stats;
+}
@@ -0,0 +1,387 @@
+#include "../../includes/simulation/sweep.hpp"
+
+#include "../../includes/simulation/thread_pool.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+	struct SweepTarget
+	{
+		AppConfig		config;
+		ControllerGains gains;
+	};
+
+	struct SweepParameter
+	{
+		std::string_view name;
+		void (*apply)(SweepTarget&, double);
+	};
+
+	constexpr std::array SWEEP_PARAMETERS = {
+		SweepParameter{"reactor.surface_area",
+					   [](SweepTarget& t, double v) { t.config.reactor.surface_area = v; }},
+		SweepParameter{"reactor.wall_thickness",
+					   [](SweepTarget& t, double v) { t.config.reactor.wall.thickness = v; }},
+		SweepParameter{"reactor.wall_thermal_conductivity", [](SweepTarget& t, double v)
+					   { t.config.reactor.wall.thermal_conductivity = v; }},
+		SweepParameter{"mass.input", [](SweepTarget& t, double v) { t.config.mass.input = v; }},
+		SweepParameter{"reaction.needed_temp",
+					   [](SweepTarget& t, double v) { t.config.reaction.needed_temp = v; }},
+		SweepParameter{"reaction.needed_humidity",
+					   [](SweepTarget& t, double v) { t.config.reaction.needed_humidity = v; }},
+		SweepParameter{"reaction.needed_pressure",
+					   [](SweepTarget& t, double v) { t.config.reaction.needed_pressure = v; }},
+		SweepParameter{"reaction.volume",
+					   [](SweepTarget& t, double v) { t.config.reaction.volume = v; }},
+		SweepParameter{"reaction.pressure",
+					   [](SweepTarget& t, double v) { t.config.reaction.pressure = v; }},
+		SweepParameter{"reaction.humidity",
+					   [](SweepTarget& t, double v) { t.config.reaction.humidity = v; }},
+		SweepParameter{"reaction.temperature",
+					   [](SweepTarget& t, double v) { t.config.reaction.temperature = v; }},
+		SweepParameter{"reaction.energy.max_consumption",
+					   [](SweepTarget& t, double v) { t.config.reaction.energy.max_consumption = v; }},
+		SweepParameter{"reaction.ambient_temperature",
+					   [](SweepTarget& t, double v) { t.config.reaction.ambient_temperature = v; }},
+		SweepParameter{"reaction.specific_gas_constant",
+					   [](SweepTarget& t, double v) { t.config.reaction.specific_gas_constant = v; }},
+		SweepParameter{"reaction.heat_transfer_coefficient", [](SweepTarget& t, double v)
+					   { t.config.reaction.heat_transfer_coefficient = v; }},
+		SweepParameter{"reaction.heat_capacity",
+					   [](SweepTarget& t, double v) { t.config.reaction.heat_capacity = v; }},
+		SweepParameter{"reaction.thermal_conductivity",
+					   [](SweepTarget& t, double v) { t.config.reaction.thermal_conductivity = v; }},
+		SweepParameter{"gains.temperature_band",
+					   [](SweepTarget& t, double v)
+					   {
+						   // kp = max_power / band: ноль или отрицательная полоса ломают регулятор
+						   if (!(v > 0.0))
+						   {
+							   throw std::invalid_argument(
+								   "gains.temperature_band must be positive");
+						   }
+						   t.gains.temperature_band = v;
+					   }},
+		SweepParameter{"gains.pressure_kp", [](SweepTarget& t, double v) { t.gains.pressure_kp = v; }},
+		SweepParameter{"gains.humidity_kp", [](SweepTarget& t, double v) { t.gains.humidity_kp = v; }},
+	};
+
+	const SweepParameter& find_parameter(std::string_view name)
+	{
+		auto found = std::ranges::find(SWEEP_PARAMETERS, name, &SweepParameter::name);
+		if (found == SWEEP_PARAMETERS.end())
+		{
+			throw std::invalid_argument("unknown sweep parameter '" + std::string(name) + "'");
+		}
+		return *found;
+	}
+
+	// splitmix64: из номера прогона и общего зерна получаем независимое зерно потока
+	std::uint64_t mix_seed(std::uint64_t value)
+	{
+		value += 0x9e3779b97f4a7c15ULL;
+		value = (value ^ (value >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+		value = (value ^ (value >> 27U)) * 0x94d049bb133111ebULL;
+		return value ^ (value >> 31U);
+	}
+
+	// Произведение размеров осей растёт быстро: четыре оси по 65536 точек переполняют
+	// size_t в ноль, поэтому умножаем с проверкой и ограничиваем общее число прогонов
+	std::size_t checked_run_product(std::size_t runs, std::size_t factor)
+	{
+		if (factor != 0 && runs > MAX_SWEEP_RUNS / factor)
+		{
+			throw std::invalid_argument("sweep is limited to " + std::to_string(MAX_SWEEP_RUNS) +
+										" runs");
+		}
+		return runs * factor;
+	}
+
+	std::size_t grid_point_count(const SweepOptions& options)
+	{
+		std::size_t points = 1;
+		for (const auto& axis : options.axes)
+		{
+			if (axis.distribution == SweepDistribution::GRID)
+			{
+				points = checked_run_product(points, axis.values.size());
+			}
+		}
+		return points;
+	}
+
+	// Конечные числа через separator; хвост после числа ("3abc") - ошибка
+	std::vector<double> split_numbers(std::string_view text, char separator)
+	{
+		std::vector<double> numbers;
+		while (true)
+		{
+			auto			 pos   = text.find(separator);
+			std::string_view token = text.substr(0, pos);
+			const char*		 last  = token.data() + token.size();
+			double			 value = 0.0;
+			const auto [end, error] = std::from_chars(token.data(), last, value);
+			if (error != std::errc{} || end != last || !std::isfinite(value))
+			{
+				throw std::invalid_argument("expected a number, got '" + std::string(token) + "'");
+			}
+			numbers.push_back(value);
+			if (pos == std::string_view::npos)
+			{
+				break;
+			}
+			text.remove_prefix(pos + 1);
+		}
+		return numbers;
+	}
+
+	SweepRow run_one(const AppConfig& base, const SweepOptions& options,
+					 const std::vector<const SweepParameter*>& targets, std::size_t run)
+	{
+		SweepRow row;
+		row.run = run;
+		row.parameters.resize(options.axes.size());
+
+		// Номер прогона -> точка сетки (последняя ось меняется быстрее всех) и номер выборки
+		std::size_t grid_index = run / options.samples;
+		for (std::size_t axis = options.axes.size(); axis-- > 0;)
+		{
+			const auto& spec = options.axes[axis];
+			if (spec.distribution == SweepDistribution::GRID)
+			{
+				row.parameters[axis] = spec.values[grid_index % spec.values.size()];
+				grid_index /= spec.values.size();
+			}
+		}
+
+		// Свой генератор на каждый прогон: результат не зависит от числа потоков и порядка
+		std::mt19937_64 rng(mix_seed(options.seed ^ mix_seed(run)));
+		for (std::size_t axis = 0; axis < options.axes.size(); ++axis)
+		{
+			const auto& spec = options.axes[axis];
+			if (spec.distribution == SweepDistribution::UNIFORM)
+			{
+				row.parameters[axis] =
+					std::uniform_real_distribution<double>(spec.first, spec.second)(rng);
+			}
+			else if (spec.distribution == SweepDistribution::NORMAL)
+			{
+				row.parameters[axis] = std::normal_distribution<double>(spec.first, spec.second)(rng);
+			}
+		}
+
+		auto start = std::chrono::steady_clock::now();
+		try
+		{
+			SweepTarget target{.config = base, .gains = ControllerGains{}};
+			for (std::size_t axis = 0; axis < targets.size(); ++axis)
+			{
+				targets[axis]->apply(target, row.parameters[axis]);
+			}
+
+			const auto& reaction = target.config.reaction;
+			Simulation	simulation(make_environment(target.config), reaction.min_temp,
+								   reaction.max_temp, 0, reaction.max_pressure, 0,
+								   reaction.max_humidity);
+			simulation.state.set_controller_gains(target.gains);
+			simulation.set_subsystem_periods(target.config.rates);
+			simulation.set_alarm_rules(target.config.alarms);
+
+			(void) run_batch(simulation, options.batch);
+
+			row.final_state = simulation.state.get_environment();
+			row.status		= simulation.state.get_status_mode();
+		}
+		catch (const std::exception& e)
+		{
+			row.error = e.what();
+		}
+		row.wall_seconds =
+			std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		return row;
+	}
+} // namespace
+
+SweepAxis parse_sweep_axis(std::string_view spec)
+{
+	auto eq = spec.find('=');
+	if (eq == std::string_view::npos || eq == 0)
+	{
+		throw std::invalid_argument("sweep axis must look like name=values: " + std::string(spec));
+	}
+
+	SweepAxis axis;
+	axis.name = std::string(spec.substr(0, eq));
+	(void) find_parameter(axis.name);
+
+	std::string_view values = spec.substr(eq + 1);
+
+	auto parse_pair = [&](std::string_view prefix, SweepDistribution distribution)
+	{
+		auto numbers = split_numbers(values.substr(prefix.size()), ':');
+		if (numbers.size() != 2)
+		{
+			throw std::invalid_argument("expected " + std::string(prefix) + "a:b in " +
+										std::string(spec));
+		}
+		axis.distribution = distribution;
+		axis.first		  = numbers[0];
+		axis.second		  = numbers[1];
+	};
+
+	// Предусловия std::uniform_real_distribution и std::normal_distribution: иначе неопределённое
+	// поведение, а не ошибка
+	if (values.starts_with("uniform:"))
+	{
+		parse_pair("uniform:", SweepDistribution::UNIFORM);
+		if (axis.first > axis.second || !std::isfinite(axis.second - axis.first))
+		{
+			throw std::invalid_argument("expected a <= b in " + std::string(spec));
+		}
+	}
+	else if (values.starts_with("normal:"))
+	{
+		parse_pair("normal:", SweepDistribution::NORMAL);
+		if (axis.second <= 0.0)
+		{
+			throw std::invalid_argument("expected a positive standard deviation in " +
+										std::string(spec));
+		}
+	}
+	else if (values.find(':') != std::string_view::npos)
+	{
+		auto numbers = split_numbers(values, ':');
+		if (numbers.size() != 3 || numbers[2] < 1.0 || numbers[2] != std::floor(numbers[2]))
+		{
+			throw std::invalid_argument("expected start:stop:count in " + std::string(spec));
+		}
+		if (numbers[2] > static_cast<double>(MAX_SWEEP_AXIS_POINTS))
+		{
+			throw std::invalid_argument("at most " + std::to_string(MAX_SWEEP_AXIS_POINTS) +
+										" points per sweep axis, got " + std::string(spec));
+		}
+
+		auto count = static_cast<std::size_t>(numbers[2]);
+		for (std::size_t i = 0; i < count; ++i)
+		{
+			double fraction = count > 1 ? (double) i / (double) (count - 1) : 0.0;
+			axis.values.push_back(numbers[0] + ((numbers[1] - numbers[0]) * fraction));
+		}
+	}
+	else
+	{
+		axis.values = split_numbers(values, ',');
+	}
+
+	return axis;
+}
+
+std::vector<std::string_view> sweep_parameter_names()
+{
+	std::vector<std::string_view> names;
+	names.reserve(SWEEP_PARAMETERS.size());
+	for (const auto& parameter : SWEEP_PARAMETERS)
+	{
+		names.push_back(parameter.name);
+	}
+	return names;
+}
+
+std::size_t sweep_run_count(const SweepOptions& options)
+{
+	return checked_run_product(grid_point_count(options), options.samples);
+}
+
+SweepTable run_sweep(const AppConfig& base, const SweepOptions& options)
+{
+	if (options.samples == 0)
+	{
+		throw std::invalid_argument("sweep needs at least one sample per grid point");
+	}
+
+	std::vector<const SweepParameter*> targets;
+	SweepTable						   table;
+	for (const auto& axis : options.axes)
+	{
+		targets.push_back(&find_parameter(axis.name));
+		table.parameter_names.push_back(axis.name);
+	}
+
+	const std::size_t runs = sweep_run_count(options);
+	table.rows.resize(runs);
+
+	auto	   start = std::chrono::steady_clock::now();
+	ThreadPool pool(options.threads);
+	table.threads = pool.size();
+
+	// Пачки по несколько прогонов: меньше накладных расходов на задачу,
+	// но достаточно мелко, чтобы кража работы выравнивала нагрузку
+	constexpr std::size_t CHUNKS_PER_THREAD = 16;
+	const std::size_t	  chunk = std::max<std::size_t>(1, runs / (pool.size() * CHUNKS_PER_THREAD));
+
+	for (std::size_t begin = 0; begin < runs; begin += chunk)
+	{
+		std::size_t end = std::min(runs, begin + chunk);
+		pool.submit(
+			[&, begin, end]
+			{
+				for (std::size_t run = begin; run < end; ++run)
+				{
+					table.rows[run] = run_one(base, options, targets, run);
+				}
+			});
+	}
+	pool.wait();
+
+	table.wall_seconds =
+		std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return table;
+}
+
+void SweepTable::write_csv(std::ostream& out) const
+{
+	auto precision = out.precision(std::numeric_limits<double>::max_digits10);
+
+	out << "run";
+	for (const auto& name : parameter_names)
+	{
+		out << ',' << name;
+	}
+	for (const auto& field : ENVIRONMENT_FIELDS)
+	{
+		out << ',' << field.name;
+	}
+	out << ",status,wall_seconds,error\n";
+
+	for (const auto& row : rows)
+	{
+		out << row.run;
+		for (double value : row.parameters)
+		{
+			out << ',' << value;
+		}
+		for (const auto& field : ENVIRONMENT_FIELDS)
+		{
+			out << ',' << row.final_state.*field.member;
+		}
+		out << ',' << status_name(row.status) << ',' << row.wall_seconds << ",\"";
+		for (char symbol : row.error)
+		{
+			out << (symbol == '"' ? "\"\"" : std::string(1, symbol));
+		}
+		out << "\"\n";
+	}
+
+	out.precision(precision);
+}
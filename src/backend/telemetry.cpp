@@ -0,0 +1,452 @@
+#include "../../includes/simulation/telemetry.hpp"
+
+#include "defs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#ifdef REACTOR_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr std::array<char, 8> HEADER_MAGIC{'R', 'C', 'T', 'L', 'M', '0', '0', '1'};
+	constexpr std::array<char, 8> FOOTER_MAGIC{'R', 'C', 'T', 'L', 'M', 'E', 'N', 'D'};
+	constexpr std::uint32_t		  FORMAT_VERSION = 1;
+
+	// Сколько блоков добавлять к файлу за раз: резервирование и mmap не на каждом блоке
+	constexpr std::size_t GROW_BLOCKS = 16;
+
+	struct Header
+	{
+		std::array<char, 8> magic;
+		std::uint32_t		version;
+		std::uint32_t		field_count;
+		std::uint64_t		block_samples;
+		std::uint64_t		samples; // обновляется после каждого тика
+	};
+
+	struct Footer
+	{
+		std::uint64_t		samples;
+		std::uint64_t		blocks;
+		std::uint64_t		index_offset;
+		std::array<char, 8> magic;
+	};
+
+	constexpr std::size_t COLUMNS	  = ENVIRONMENT_FIELD_COUNT + 1; // время + поля
+	constexpr std::size_t BLOCK_BYTES = COLUMNS * TELEMETRY_BLOCK_SAMPLES * sizeof(double);
+
+	static_assert(sizeof(Header) + (ENVIRONMENT_FIELD_COUNT * TELEMETRY_NAME_LENGTH) <=
+				  TELEMETRY_DATA_OFFSET);
+	static_assert(sizeof(std::uint64_t) == sizeof(double));
+
+	std::size_t block_offset(std::size_t block)
+	{
+		return TELEMETRY_DATA_OFFSET + (block * BLOCK_BYTES);
+	}
+
+	std::size_t column_offset(std::size_t column)
+	{
+		return column * TELEMETRY_BLOCK_SAMPLES * sizeof(double);
+	}
+
+	std::size_t blocks_for(std::uint64_t samples)
+	{
+		return (samples + TELEMETRY_BLOCK_SAMPLES - 1) / TELEMETRY_BLOCK_SAMPLES;
+	}
+
+	// error - errno, сохранённый до close/munmap: они его перезаписывают
+	[[noreturn]] void fail(const std::string& what, const std::string& path, int error)
+	{
+		throw TelemetryError("telemetry: " + what + " '" + path + "': " + std::strerror(error));
+	}
+
+#ifdef REACTOR_POSIX
+	// Резервирует место под байты [from, to) файла, который сейчас длиной from.
+	// 0 или код ошибки
+	int reserve(int file, std::size_t from, std::size_t to)
+	{
+#ifdef REACTOR_LINUX
+		(void) from;
+		return ::posix_fallocate(file, 0, static_cast<off_t>(to));
+#else
+		// posix_fallocate есть не везде (нет на macOS): растим файл и пишем по байту в каждый
+		// блок файловой системы, чтобы нехватку места вернул pwrite, а не SIGBUS в отображении
+		if (::ftruncate(file, static_cast<off_t>(to)) != 0)
+		{
+			return errno;
+		}
+		struct stat info{};
+		if (::fstat(file, &info) != 0)
+		{
+			return errno;
+		}
+		const auto step = static_cast<std::size_t>(std::max<blksize_t>(info.st_blksize, 1));
+		const char zero = 0;
+		// Первый новый байт каждого задетого блока; новые байты и так нулевые
+		for (std::size_t offset = from; offset < to; offset = ((offset / step) + 1) * step)
+		{
+			if (::pwrite(file, &zero, 1, static_cast<off_t>(offset)) != 1)
+			{
+				return errno != 0 ? errno : EIO;
+			}
+		}
+		return 0;
+#endif
+	}
+#endif
+} // namespace
+
+#ifdef REACTOR_POSIX
+
+TelemetryWriter::TelemetryWriter(const std::string& path) : path(path)
+{
+	file = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644); // NOLINT(cppcoreguidelines-pro-type-vararg)
+	if (file < 0)
+	{
+		fail("failed to create", path, errno);
+	}
+
+	if (!remap(block_offset(GROW_BLOCKS)))
+	{
+		::close(file);
+		file = -1;
+		throw TelemetryError("telemetry: " + error);
+	}
+
+	Header header{.magic		 = HEADER_MAGIC,
+				  .version		 = FORMAT_VERSION,
+				  .field_count	 = ENVIRONMENT_FIELD_COUNT,
+				  .block_samples = TELEMETRY_BLOCK_SAMPLES,
+				  .samples		 = 0};
+	std::memcpy(mapping, &header, sizeof(header));
+
+	std::byte* names = mapping + sizeof(Header);
+	for (const auto& field : ENVIRONMENT_FIELDS)
+	{
+		std::memcpy(names, field.name.data(), std::min(field.name.size(), TELEMETRY_NAME_LENGTH - 1));
+		names += TELEMETRY_NAME_LENGTH;
+	}
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+	try
+	{
+		close();
+	}
+	catch (const TelemetryError&) // NOLINT(bugprone-empty-catch)
+	{
+		// Из деструктора не бросаем; заголовок уже содержит число отсчётов
+	}
+}
+
+bool TelemetryWriter::remap(std::size_t bytes)
+{
+	// Место резервируется по-настоящему: после ftruncate файл разреженный, и на полном диске
+	// первая запись в новую страницу отображения приходит SIGBUS, а не ошибкой
+	const int reserved = reserve(file, mapped_bytes, bytes);
+	if (reserved != 0)
+	{
+		error = "failed to grow '" + path + "': " + std::strerror(reserved);
+		return false;
+	}
+
+	// Новое отображение - до снятия старого: при ошибке старое остаётся целым
+	void* address = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	if (address == MAP_FAILED)
+	{
+		error = "failed to map '" + path + "': " + std::strerror(errno);
+		return false;
+	}
+	if (mapping != nullptr)
+	{
+		::munmap(mapping, mapped_bytes);
+	}
+	mapping		 = static_cast<std::byte*>(address);
+	mapped_bytes = bytes;
+	return true;
+}
+
+void TelemetryWriter::append(unsigned long sim_time_millis, const Environment& env)
+{
+	if (failed)
+	{
+		++dropped;
+		return;
+	}
+
+	const std::size_t block = samples / TELEMETRY_BLOCK_SAMPLES;
+	const std::size_t row	= samples % TELEMETRY_BLOCK_SAMPLES;
+	if (block_offset(block + 1) > mapped_bytes && !remap(block_offset(block + GROW_BLOCKS)))
+	{
+		// Зовётся из потока симуляции: не бросаем, а дальше только считаем потерянные отсчёты
+		failed = true;
+		++dropped;
+		return;
+	}
+
+	std::byte*			base = mapping + block_offset(block);
+	const std::uint64_t time = sim_time_millis;
+	std::memcpy(base + column_offset(0) + (row * sizeof(time)), &time, sizeof(time));
+	for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		const double value = env.*ENVIRONMENT_FIELDS[field].member;
+		std::memcpy(base + column_offset(field + 1) + (row * sizeof(value)), &value, sizeof(value));
+	}
+
+	++samples;
+	std::memcpy(mapping + offsetof(Header, samples), &samples, sizeof(samples));
+}
+
+void TelemetryWriter::close()
+{
+	if (file < 0)
+	{
+		return;
+	}
+
+	const std::size_t blocks = blocks_for(samples);
+	std::vector<TelemetryReader::BlockIndex> index(blocks);
+	for (std::size_t block = 0; block < blocks; ++block)
+	{
+		const std::size_t last = std::min<std::uint64_t>(samples - (block * TELEMETRY_BLOCK_SAMPLES),
+														 TELEMETRY_BLOCK_SAMPLES) -
+								 1;
+		const std::byte* times = mapping + block_offset(block);
+		std::memcpy(&index[block].first_time, times, sizeof(std::uint64_t));
+		std::memcpy(&index[block].last_time, times + (last * sizeof(std::uint64_t)),
+					sizeof(std::uint64_t));
+	}
+
+	const std::size_t index_offset = block_offset(blocks);
+	const std::size_t index_bytes  = blocks * sizeof(TelemetryReader::BlockIndex);
+	std::size_t		  total		   = index_offset + index_bytes + sizeof(Footer);
+
+	if (total <= mapped_bytes || remap(total))
+	{
+		Footer footer{.samples		= samples,
+					  .blocks		= blocks,
+					  .index_offset = index_offset,
+					  .magic		= FOOTER_MAGIC};
+		std::memcpy(mapping + index_offset, index.data(), index_bytes);
+		std::memcpy(mapping + index_offset + index_bytes, &footer, sizeof(footer));
+	}
+	else
+	{
+		// Места нет и под индекс: файл остаётся незакрытым, читатель возьмёт число отсчётов
+		// из заголовка и построит индекс сам
+		failed = true;
+		total  = index_offset;
+	}
+
+	::msync(mapping, std::min(total, mapped_bytes), MS_SYNC);
+	::munmap(mapping, mapped_bytes);
+	mapping		 = nullptr;
+	mapped_bytes = 0;
+
+	const bool truncated = ::ftruncate(file, static_cast<off_t>(total)) == 0;
+	const int  error	 = errno;
+	::close(file);
+	file = -1;
+	if (!truncated)
+	{
+		fail("failed to finish", path, error);
+	}
+}
+
+TelemetryReader::TelemetryReader(const std::string& path)
+{
+	file = ::open(path.c_str(), O_RDONLY); // NOLINT(cppcoreguidelines-pro-type-vararg)
+	if (file < 0)
+	{
+		fail("failed to open", path, errno);
+	}
+
+	struct stat info{};
+	if (::fstat(file, &info) != 0)
+	{
+		const int error = errno;
+		::close(file);
+		fail("failed to stat", path, error);
+	}
+	mapped_bytes = static_cast<std::size_t>(info.st_size);
+	if (mapped_bytes < TELEMETRY_DATA_OFFSET)
+	{
+		::close(file);
+		throw TelemetryError("telemetry: '" + path + "' is too short");
+	}
+
+	void* address = ::mmap(nullptr, mapped_bytes, PROT_READ, MAP_SHARED, file, 0);
+	if (address == MAP_FAILED)
+	{
+		const int error = errno;
+		::close(file);
+		fail("failed to map", path, error);
+	}
+	mapping = static_cast<const std::byte*>(address);
+
+	try
+	{
+		load_index(path);
+	}
+	catch (const TelemetryError&)
+	{
+		::munmap(address, mapped_bytes);
+		::close(file);
+		throw;
+	}
+}
+
+void TelemetryReader::load_index(const std::string& path)
+{
+	Header header{};
+	std::memcpy(&header, mapping, sizeof(header));
+	if (header.magic != HEADER_MAGIC || header.version != FORMAT_VERSION ||
+		header.block_samples != TELEMETRY_BLOCK_SAMPLES)
+	{
+		throw TelemetryError("telemetry: '" + path + "' is not a telemetry file of version " +
+							 std::to_string(FORMAT_VERSION));
+	}
+	if (header.field_count != ENVIRONMENT_FIELD_COUNT)
+	{
+		throw TelemetryError("telemetry: '" + path + "' has " +
+							 std::to_string(header.field_count) + " fields, expected " +
+							 std::to_string(ENVIRONMENT_FIELD_COUNT));
+	}
+
+	const std::byte* name = mapping + sizeof(Header);
+	for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		const auto* text = reinterpret_cast<const char*>(name); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+		names.emplace_back(text, strnlen(text, TELEMETRY_NAME_LENGTH));
+		name += TELEMETRY_NAME_LENGTH;
+	}
+
+	Footer footer{};
+	if (mapped_bytes >= TELEMETRY_DATA_OFFSET + sizeof(Footer))
+	{
+		std::memcpy(&footer, mapping + mapped_bytes - sizeof(Footer), sizeof(footer));
+	}
+
+	if (footer.magic == FOOTER_MAGIC &&
+		footer.index_offset + (footer.blocks * sizeof(BlockIndex)) + sizeof(Footer) == mapped_bytes)
+	{
+		samples = footer.samples;
+		index.resize(footer.blocks);
+		std::memcpy(index.data(), mapping + footer.index_offset, footer.blocks * sizeof(BlockIndex));
+	}
+	else
+	{
+		// Файл не закрыли: берём число отсчётов из заголовка, индекс строим по блокам
+		samples = std::min<std::uint64_t>(header.samples, ((mapped_bytes - TELEMETRY_DATA_OFFSET) /
+														   BLOCK_BYTES) * TELEMETRY_BLOCK_SAMPLES);
+		index.resize(blocks_for(samples));
+		for (std::size_t number = 0; number < index.size(); ++number)
+		{
+			const std::size_t last =
+				std::min<std::uint64_t>(samples - (number * TELEMETRY_BLOCK_SAMPLES),
+										TELEMETRY_BLOCK_SAMPLES) -
+				1;
+			std::memcpy(&index[number].first_time, block(number), sizeof(std::uint64_t));
+			std::memcpy(&index[number].last_time, block(number) + (last * sizeof(std::uint64_t)),
+						sizeof(std::uint64_t));
+		}
+	}
+}
+
+TelemetryReader::~TelemetryReader()
+{
+	if (mapping != nullptr)
+	{
+		::munmap(const_cast<std::byte*>(mapping), mapped_bytes); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+	}
+	if (file >= 0)
+	{
+		::close(file);
+	}
+}
+
+#else
+
+TelemetryWriter::TelemetryWriter(const std::string& path) : path(path)
+{
+	throw TelemetryError("telemetry: memory-mapped files need a POSIX system");
+}
+
+TelemetryWriter::~TelemetryWriter() = default;
+
+bool TelemetryWriter::remap(std::size_t /*bytes*/)
+{
+	return false;
+}
+
+void TelemetryWriter::append(unsigned long /*sim_time_millis*/, const Environment& /*env*/) {}
+
+void TelemetryWriter::close() {}
+
+TelemetryReader::TelemetryReader(const std::string& /*path*/)
+{
+	throw TelemetryError("telemetry: memory-mapped files need a POSIX system");
+}
+
+TelemetryReader::~TelemetryReader() = default;
+
+void TelemetryReader::load_index(const std::string& /*path*/) {}
+
+#endif
+
+const std::byte* TelemetryReader::block(std::size_t number) const
+{
+	return mapping + block_offset(number);
+}
+
+std::vector<TelemetryReader::Slice> TelemetryReader::range(std::uint64_t from_millis,
+														   std::uint64_t to_millis) const
+{
+	std::vector<Slice> slices;
+
+	// Первый блок, который может содержать from_millis
+	auto first = std::ranges::partition_point(
+		index, [from_millis](const BlockIndex& entry) { return entry.last_time < from_millis; });
+
+	for (auto entry = first; entry != index.end() && entry->first_time <= to_millis; ++entry)
+	{
+		const auto		  number = static_cast<std::size_t>(entry - index.begin());
+		const std::size_t count	 = std::min<std::uint64_t>(
+			 samples - (number * TELEMETRY_BLOCK_SAMPLES), TELEMETRY_BLOCK_SAMPLES);
+
+		const std::byte* base = block(number);
+		// Колонки выровнены на 8 байт: блоки начинаются со страницы, колонки кратны 8
+		std::span<const std::uint64_t> times(
+			reinterpret_cast<const std::uint64_t*>(base), count); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+
+		auto begin = std::ranges::lower_bound(times, from_millis);
+		auto end   = std::ranges::upper_bound(times, to_millis);
+		if (begin >= end)
+		{
+			continue;
+		}
+
+		Slice			  slice;
+		const std::size_t offset = static_cast<std::size_t>(begin - times.begin());
+		slice.times				 = times.subspan(offset, static_cast<std::size_t>(end - begin));
+		for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+		{
+			slice.columns[field] = reinterpret_cast<const double*>( // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+									   base + column_offset(field + 1)) +
+								   offset;
+		}
+		slices.push_back(slice);
+	}
+
+	return slices;
+}
@@ -0,0 +1,538 @@
+#include "../../includes/simulation/thermo_kernels.hpp"
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define REACTOR_KERNELS_X86
+#endif
+
+namespace kernels
+{
+	namespace
+	{
+		// ===Скалярная версия: ровно те же выражения, что и в Thermodynamics===
+
+		void total_heat_loss_scalar(const HeatLossInputs& in, const RadiationParams& params,
+									double* out, std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				double temperature = in.temperature[i];
+				double ambient	   = in.ambient_temperature[i];
+				double area		   = in.surface_area[i];
+				double thickness   = in.wall_thickness[i];
+
+				double conduction =
+					thickness <= 0.0
+						? 0.0
+						: in.wall_thermal_conductivity[i] * area * (temperature - ambient) / thickness;
+				double convection = in.heat_transfer_coefficient[i] * area * (temperature - ambient);
+				double radiation  = params.stefan_boltzmann * params.emissivity * area *
+								   (std::pow(temperature, 4) - std::pow(ambient, 4));
+
+				out[i] = conduction + convection + radiation;
+			}
+		}
+
+		void arrhenius_heat_rate_scalar(const double* temperature, const double* mass,
+										const ArrheniusParams& params, double* out,
+										std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				if (temperature[i] <= 0.0)
+				{
+					out[i] = 0.0;
+					continue;
+				}
+
+				double rate_constant =
+					params.rate_constant *
+					std::exp(-params.activation_energy / (params.gas_constant * temperature[i]));
+				out[i] = rate_constant * mass[i] * params.heat_of_reaction;
+			}
+		}
+
+		void dittus_boelter_scalar(const double* thermal_conductivity, const double* mass,
+								   const double* volume, const double* heat_capacity,
+								   const DittusBoelterParams& params, double* out,
+								   std::size_t count)
+		{
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				double density = mass[i] / volume[i];
+				double reynolds_number =
+					density * params.flow_velocity * params.characteristic_length / params.viscosity;
+				double prandtl_number = params.viscosity * heat_capacity[i] / thermal_conductivity[i];
+				double nusselt_number = params.coefficient *
+										std::pow(reynolds_number, params.reynolds_exponent) *
+										std::pow(prandtl_number, params.prandtl_exponent);
+
+				out[i] = nusselt_number * thermal_conductivity[i] / params.characteristic_length;
+			}
+		}
+
+#if defined(REACTOR_KERNELS_X86)
+		// Векторные версии - в конце файла, см. комментарий там
+		__attribute__((target("avx2,fma"))) void
+		total_heat_loss_avx2(const HeatLossInputs& in, const RadiationParams& params, double* out,
+							 std::size_t count);
+		__attribute__((target("avx2,fma"))) void
+		arrhenius_heat_rate_avx2(const double* temperature, const double* mass,
+								 const ArrheniusParams& params, double* out, std::size_t count);
+		__attribute__((target("avx2,fma"))) void
+		dittus_boelter_avx2(const double* thermal_conductivity, const double* mass,
+							const double* volume, const double* heat_capacity,
+							const DittusBoelterParams& params, double* out, std::size_t count);
+		__attribute__((target("avx512f"))) void
+		total_heat_loss_avx512(const HeatLossInputs& in, const RadiationParams& params, double* out,
+							   std::size_t count);
+		__attribute__((target("avx512f"))) void
+		arrhenius_heat_rate_avx512(const double* temperature, const double* mass,
+								   const ArrheniusParams& params, double* out, std::size_t count);
+		__attribute__((target("avx512f"))) void
+		dittus_boelter_avx512(const double* thermal_conductivity, const double* mass,
+							  const double* volume, const double* heat_capacity,
+							  const DittusBoelterParams& params, double* out, std::size_t count);
+#endif
+
+		Isa detect()
+		{
+#if defined(REACTOR_KERNELS_X86)
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return Isa::AVX512;
+			}
+			if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+			{
+				return Isa::AVX2;
+			}
+#endif
+			return Isa::SCALAR;
+		}
+
+		std::atomic<Isa>& current_isa()
+		{
+			static std::atomic<Isa> isa{detect()};
+			return isa;
+		}
+	} // namespace
+
+	std::string_view isa_name(Isa isa)
+	{
+		switch (isa)
+		{
+		case Isa::SCALAR:
+			return "scalar";
+		case Isa::AVX2:
+			return "avx2";
+		case Isa::AVX512:
+			return "avx512";
+		}
+		return "unknown";
+	}
+
+	Isa detected_isa()
+	{
+		static const Isa DETECTED = detect();
+		return DETECTED;
+	}
+
+	Isa active_isa()
+	{
+		return current_isa().load(std::memory_order_relaxed);
+	}
+
+	bool set_isa(Isa isa)
+	{
+		if (static_cast<std::uint8_t>(isa) > static_cast<std::uint8_t>(detected_isa()))
+		{
+			return false;
+		}
+		current_isa().store(isa, std::memory_order_relaxed);
+		return true;
+	}
+
+	void total_heat_loss(const HeatLossInputs& inputs, const RadiationParams& params, double* out,
+						 std::size_t count)
+	{
+		switch (active_isa())
+		{
+#if defined(REACTOR_KERNELS_X86)
+		case Isa::AVX512:
+			total_heat_loss_avx512(inputs, params, out, count);
+			return;
+		case Isa::AVX2:
+			total_heat_loss_avx2(inputs, params, out, count);
+			return;
+#endif
+		default:
+			total_heat_loss_scalar(inputs, params, out, count);
+			return;
+		}
+	}
+
+	void arrhenius_heat_rate(const double* temperature, const double* mass,
+							 const ArrheniusParams& params, double* out, std::size_t count)
+	{
+		switch (active_isa())
+		{
+#if defined(REACTOR_KERNELS_X86)
+		case Isa::AVX512:
+			arrhenius_heat_rate_avx512(temperature, mass, params, out, count);
+			return;
+		case Isa::AVX2:
+			arrhenius_heat_rate_avx2(temperature, mass, params, out, count);
+			return;
+#endif
+		default:
+			arrhenius_heat_rate_scalar(temperature, mass, params, out, count);
+			return;
+		}
+	}
+
+	void dittus_boelter(const double* thermal_conductivity, const double* mass, const double* volume,
+						const double* heat_capacity, const DittusBoelterParams& params, double* out,
+						std::size_t count)
+	{
+		switch (active_isa())
+		{
+#if defined(REACTOR_KERNELS_X86)
+		case Isa::AVX512:
+			dittus_boelter_avx512(thermal_conductivity, mass, volume, heat_capacity, params, out,
+								  count);
+			return;
+		case Isa::AVX2:
+			dittus_boelter_avx2(thermal_conductivity, mass, volume, heat_capacity, params, out,
+								count);
+			return;
+#endif
+		default:
+			dittus_boelter_scalar(thermal_conductivity, mass, volume, heat_capacity, params, out,
+								  count);
+			return;
+		}
+	}
+} // namespace kernels
+
+#if defined(REACTOR_KERNELS_X86)
+namespace kernels
+{
+	namespace
+	{
+		// ===Векторная версия на векторных расширениях GCC/Clang===
+		// Один и тот же шаблон собирается под AVX2 (4 x double) и AVX-512 (8 x double).
+
+#if defined(__GNUC__) && !defined(__clang__)
+		// Вспомогательные функции всегда встраиваются в функции с target(...), ABI не важен.
+		// Для шаблонов GCC выдаёт -Wpsabi на последней строке единицы трансляции, где
+		// push/pop уже закрыт и предупреждение вернулось бы. Поэтому векторная часть стоит
+		// в самом конце файла: отключение действует только на неё
+#pragma GCC diagnostic ignored "-Wpsabi"
+#endif
+
+		using Vec4	= double __attribute__((vector_size(32)));
+		using Mask4 = long long __attribute__((vector_size(32)));
+		using Vec8	= double __attribute__((vector_size(64)));
+		using Mask8 = long long __attribute__((vector_size(64)));
+
+		template <typename V> struct VecTraits;
+
+		template <> struct VecTraits<Vec4>
+		{
+			using Mask						 = Mask4;
+			static constexpr std::size_t WIDTH = 4;
+		};
+
+		template <> struct VecTraits<Vec8>
+		{
+			using Mask						 = Mask8;
+			static constexpr std::size_t WIDTH = 8;
+		};
+
+		template <typename V> using MaskOf = typename VecTraits<V>::Mask;
+
+		constexpr double EXP_UPPER	 = 709.0;
+		constexpr double EXP_LOWER	 = -708.0;
+		constexpr double LOG2E		 = 1.4426950408889634074;
+		constexpr double LN2_HI		 = 6.93147180369123816490e-01;
+		constexpr double LN2_LO		 = 1.90821492927058770002e-10;
+		constexpr double SQRT2		 = 1.41421356237309504880;
+		constexpr double ROUND_MAGIC = 6755399441055744.0; // 1.5 * 2^52
+		constexpr long long EXPONENT_BIAS = 1023;
+		constexpr int		MANTISSA_BITS = 52;
+		constexpr long long MANTISSA_MASK = 0x000fffffffffffffLL;
+		constexpr long long EXPONENT_MASK = 0x7ffLL;
+		constexpr long long ONE_BITS	  = 0x3ff0000000000000LL;
+
+		template <typename V> [[gnu::always_inline]] inline V splat(double value)
+		{
+			return V{} + value;
+		}
+
+		template <typename V> [[gnu::always_inline]] inline V load(const double* ptr)
+		{
+			V value;
+			std::memcpy(&value, ptr, sizeof(V));
+			return value;
+		}
+
+		template <typename V> [[gnu::always_inline]] inline void store(double* ptr, const V& value)
+		{
+			std::memcpy(ptr, &value, sizeof(V));
+		}
+
+		template <typename V> [[gnu::always_inline]] inline V select(const MaskOf<V>& mask, const V& yes, const V& no)
+		{
+			using M = MaskOf<V>;
+			return (V) (((M) yes & mask) | ((M) no & ~mask));
+		}
+
+		// exp(x): x = n*ln2 + r, |r| <= ln2/2, exp(r) - ряд Тейлора до r^13
+		template <typename V> [[gnu::always_inline]] inline V exp_approx(const V& x)
+		{
+			using M = MaskOf<V>;
+
+			M above = x > splat<V>(EXP_UPPER);
+			M below = x < splat<V>(EXP_LOWER);
+			V clamped = select(above, splat<V>(EXP_UPPER), x);
+			clamped	  = select(below, splat<V>(EXP_LOWER), clamped);
+
+			V shifted = clamped * LOG2E + ROUND_MAGIC;
+			V n		  = shifted - ROUND_MAGIC;
+			M n_int	  = (M) shifted - (M) splat<V>(ROUND_MAGIC);
+
+			V r = clamped - n * LN2_HI;
+			r	= r - n * LN2_LO;
+
+			V p = splat<V>(1.0 / 6227020800.0); // 1/13!
+			p	= p * r + 1.0 / 479001600.0;
+			p	= p * r + 1.0 / 39916800.0;
+			p	= p * r + 1.0 / 3628800.0;
+			p	= p * r + 1.0 / 362880.0;
+			p	= p * r + 1.0 / 40320.0;
+			p	= p * r + 1.0 / 5040.0;
+			p	= p * r + 1.0 / 720.0;
+			p	= p * r + 1.0 / 120.0;
+			p	= p * r + 1.0 / 24.0;
+			p	= p * r + 1.0 / 6.0;
+			p	= p * r + 0.5;
+			p	= p * r + 1.0;
+			p	= p * r + 1.0;
+
+			V scale	 = (V) ((n_int + EXPONENT_BIAS) << MANTISSA_BITS);
+			V result = p * scale;
+
+			result = select(above, splat<V>(std::numeric_limits<double>::infinity()), result);
+			return select(below, splat<V>(0.0), result);
+		}
+
+		// log(x) = k*ln2 + log(m), m в [sqrt(1/2), sqrt(2)), log(m) = 2*atanh((m-1)/(m+1))
+		template <typename V> [[gnu::always_inline]] inline V log_approx(const V& x)
+		{
+			using M = MaskOf<V>;
+
+			M bits	   = (M) x;
+			M exponent = ((bits >> MANTISSA_BITS) & EXPONENT_MASK) - EXPONENT_BIAS;
+			V mantissa = (V) ((bits & MANTISSA_MASK) | ONE_BITS);
+
+			M big	 = mantissa > splat<V>(SQRT2);
+			mantissa = select(big, mantissa * 0.5, mantissa);
+			exponent = exponent - big; // big == -1 там, где условие истинно
+
+			V k = (V) (exponent + (M) splat<V>(ROUND_MAGIC)) - ROUND_MAGIC;
+
+			V f	 = (mantissa - 1.0) / (mantissa + 1.0);
+			V f2 = f * f;
+
+			V s = splat<V>(1.0 / 21.0);
+			s	= s * f2 + 1.0 / 19.0;
+			s	= s * f2 + 1.0 / 17.0;
+			s	= s * f2 + 1.0 / 15.0;
+			s	= s * f2 + 1.0 / 13.0;
+			s	= s * f2 + 1.0 / 11.0;
+			s	= s * f2 + 1.0 / 9.0;
+			s	= s * f2 + 1.0 / 7.0;
+			s	= s * f2 + 1.0 / 5.0;
+			s	= s * f2 + 1.0 / 3.0;
+			s	= s * f2;
+
+			V log_m	 = 2.0 * f + 2.0 * f * s;
+			V result = k * LN2_HI + (log_m + k * LN2_LO);
+
+			result = select(x == 0.0, splat<V>(-std::numeric_limits<double>::infinity()), result);
+			result = select(x == std::numeric_limits<double>::infinity(),
+							splat<V>(std::numeric_limits<double>::infinity()), result);
+			return select(~(x >= 0.0), splat<V>(std::numeric_limits<double>::quiet_NaN()), result);
+		}
+
+		template <typename V>
+		[[gnu::always_inline]] inline V total_heat_loss_lane(const V& temperature, const V& ambient, const V& area,
+															   const V& thickness, const V& wall_conductivity,
+															   const V& heat_transfer_coefficient,
+															   const RadiationParams& params)
+		{
+			V conduction = select(thickness <= 0.0, splat<V>(0.0),
+								  wall_conductivity * area * (temperature - ambient) / thickness);
+			V convection = heat_transfer_coefficient * area * (temperature - ambient);
+
+			V t2		= temperature * temperature;
+			V a2		= ambient * ambient;
+			V radiation = params.stefan_boltzmann * params.emissivity * area * (t2 * t2 - a2 * a2);
+
+			return conduction + convection + radiation;
+		}
+
+		template <typename V>
+		[[gnu::always_inline]] inline V arrhenius_lane(const V& temperature, const V& mass,
+													   const ArrheniusParams& params)
+		{
+			V exponent = -params.activation_energy / (params.gas_constant * temperature);
+			V rate	   = params.rate_constant * exp_approx(exponent);
+			return select(temperature <= 0.0, splat<V>(0.0), rate * mass * params.heat_of_reaction);
+		}
+
+		template <typename V>
+		[[gnu::always_inline]] inline V dittus_boelter_lane(const V& thermal_conductivity, const V& mass, const V& volume,
+															const V& heat_capacity,
+															const DittusBoelterParams& params)
+		{
+			V density = mass / volume;
+			V reynolds_number =
+				density * params.flow_velocity * params.characteristic_length / params.viscosity;
+			V prandtl_number = params.viscosity * heat_capacity / thermal_conductivity;
+
+			// Re^a * Pr^b = exp(a*ln(Re) + b*ln(Pr)): одна экспонента вместо двух pow
+			V nusselt_number =
+				params.coefficient * exp_approx(params.reynolds_exponent * log_approx(reynolds_number) +
+												params.prandtl_exponent * log_approx(prandtl_number));
+
+			return nusselt_number * thermal_conductivity / params.characteristic_length;
+		}
+
+		// Хвост массива считается одной векторной итерацией по дополненной копии,
+		// чтобы все реакторы получали одинаковую точность.
+		template <typename V, std::size_t INPUTS, typename Lane>
+		[[gnu::always_inline]] inline void run_columns(const std::array<const double*, INPUTS>& inputs,
+													   double* out, std::size_t count, Lane lane)
+		{
+			constexpr std::size_t WIDTH = VecTraits<V>::WIDTH;
+
+			std::size_t i = 0;
+			for (; i + WIDTH <= count; i += WIDTH)
+			{
+				std::array<V, INPUTS> lanes;
+				for (std::size_t input = 0; input < INPUTS; ++input)
+				{
+					lanes[input] = load<V>(inputs[input] + i);
+				}
+				store(out + i, lane(lanes));
+			}
+
+			if (i < count)
+			{
+				std::size_t							 tail = count - i;
+				std::array<std::array<double, WIDTH>, INPUTS> padded{};
+				std::array<V, INPUTS>								 lanes;
+				for (std::size_t input = 0; input < INPUTS; ++input)
+				{
+					padded[input].fill(1.0);
+					std::memcpy(padded[input].data(), inputs[input] + i, tail * sizeof(double));
+					lanes[input] = load<V>(padded[input].data());
+				}
+
+				std::array<double, WIDTH> result{};
+				store(result.data(), lane(lanes));
+				std::memcpy(out + i, result.data(), tail * sizeof(double));
+			}
+		}
+
+		template <typename V> struct HeatLossLane
+		{
+			const RadiationParams& params;
+
+			[[gnu::always_inline]] V operator()(const std::array<V, 6>& v) const
+			{
+				return total_heat_loss_lane(v[0], v[1], v[2], v[3], v[4], v[5], params);
+			}
+		};
+
+		template <typename V> struct ArrheniusLane
+		{
+			const ArrheniusParams& params;
+
+			[[gnu::always_inline]] V operator()(const std::array<V, 2>& v) const
+			{
+				return arrhenius_lane(v[0], v[1], params);
+			}
+		};
+
+		template <typename V> struct DittusBoelterLane
+		{
+			const DittusBoelterParams& params;
+
+			[[gnu::always_inline]] V operator()(const std::array<V, 4>& v) const
+			{
+				return dittus_boelter_lane(v[0], v[1], v[2], v[3], params);
+			}
+		};
+
+		__attribute__((target("avx2,fma"))) void
+		total_heat_loss_avx2(const HeatLossInputs& in, const RadiationParams& params, double* out,
+							 std::size_t count)
+		{
+			run_columns<Vec4, 6>({in.temperature, in.ambient_temperature, in.surface_area,
+								  in.wall_thickness, in.wall_thermal_conductivity,
+								  in.heat_transfer_coefficient},
+								 out, count, HeatLossLane<Vec4>{params});
+		}
+
+		__attribute__((target("avx2,fma"))) void
+		arrhenius_heat_rate_avx2(const double* temperature, const double* mass,
+								 const ArrheniusParams& params, double* out, std::size_t count)
+		{
+			run_columns<Vec4, 2>({temperature, mass}, out, count, ArrheniusLane<Vec4>{params});
+		}
+
+		__attribute__((target("avx2,fma"))) void
+		dittus_boelter_avx2(const double* thermal_conductivity, const double* mass,
+							const double* volume, const double* heat_capacity,
+							const DittusBoelterParams& params, double* out, std::size_t count)
+		{
+			run_columns<Vec4, 4>({thermal_conductivity, mass, volume, heat_capacity}, out, count,
+								 DittusBoelterLane<Vec4>{params});
+		}
+
+		__attribute__((target("avx512f"))) void
+		total_heat_loss_avx512(const HeatLossInputs& in, const RadiationParams& params, double* out,
+							   std::size_t count)
+		{
+			run_columns<Vec8, 6>({in.temperature, in.ambient_temperature, in.surface_area,
+								  in.wall_thickness, in.wall_thermal_conductivity,
+								  in.heat_transfer_coefficient},
+								 out, count, HeatLossLane<Vec8>{params});
+		}
+
+		__attribute__((target("avx512f"))) void
+		arrhenius_heat_rate_avx512(const double* temperature, const double* mass,
+								   const ArrheniusParams& params, double* out, std::size_t count)
+		{
+			run_columns<Vec8, 2>({temperature, mass}, out, count, ArrheniusLane<Vec8>{params});
+		}
+
+		__attribute__((target("avx512f"))) void
+		dittus_boelter_avx512(const double* thermal_conductivity, const double* mass,
+							  const double* volume, const double* heat_capacity,
+							  const DittusBoelterParams& params, double* out, std::size_t count)
+		{
+			run_columns<Vec8, 4>({thermal_conductivity, mass, volume, heat_capacity}, out, count,
+								 DittusBoelterLane<Vec8>{params});
+		}
+	} // namespace
+} // namespace kernels
+#endif // REACTOR_KERNELS_X86
@@ -0,0 +1,134 @@
+#include "../../includes/simulation/thread_pool.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <string>
+
+ThreadPool::ThreadPool(std::size_t thread_count)
+{
+	if (thread_count == 0)
+	{
+		thread_count = std::max(1U, std::thread::hardware_concurrency());
+	}
+
+	workers.reserve(thread_count);
+	for (std::size_t i = 0; i < thread_count; ++i)
+	{
+		workers.push_back(std::make_unique<Worker>());
+	}
+
+	threads.reserve(thread_count);
+	for (std::size_t i = 0; i < thread_count; ++i)
+	{
+		threads.emplace_back(&ThreadPool::run, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::scoped_lock lock(wake_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+void ThreadPool::submit(Task task)
+{
+	std::size_t index = next_queue.fetch_add(1, std::memory_order_relaxed) % workers.size();
+
+	pending.fetch_add(1, std::memory_order_acq_rel);
+	{
+		std::scoped_lock lock(workers[index]->mutex);
+		workers[index]->tasks.push_back(std::move(task));
+	}
+	queued.fetch_add(1, std::memory_order_release);
+
+	{
+		std::scoped_lock lock(wake_mutex);
+	}
+	wake.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	std::unique_lock lock(wake_mutex);
+	idle.wait(lock, [this] { return pending.load(std::memory_order_acquire) == 0; });
+}
+
+bool ThreadPool::try_pop(std::size_t index, Task& task)
+{
+	Worker&			 worker = *workers[index];
+	std::scoped_lock lock(worker.mutex);
+	if (worker.tasks.empty())
+	{
+		return false;
+	}
+
+	task = std::move(worker.tasks.back());
+	worker.tasks.pop_back();
+	queued.fetch_sub(1, std::memory_order_relaxed);
+	return true;
+}
+
+bool ThreadPool::try_steal(std::size_t thief, Task& task)
+{
+	for (std::size_t offset = 1; offset < workers.size(); ++offset)
+	{
+		Worker&			 victim = *workers[(thief + offset) % workers.size()];
+		std::scoped_lock lock(victim.mutex);
+		if (!victim.tasks.empty())
+		{
+			task = std::move(victim.tasks.front());
+			victim.tasks.pop_front();
+			queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::finish_task()
+{
+	if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+	{
+		{
+			std::scoped_lock lock(wake_mutex);
+		}
+		idle.notify_all();
+	}
+}
+
+void ThreadPool::run(std::size_t index)
+{
+	Tracer::set_thread_name("worker " + std::to_string(index));
+
+	for (;;)
+	{
+		Task task;
+		if (try_pop(index, task) || try_steal(index, task))
+		{
+			task();
+			finish_task();
+			continue;
+		}
+
+		std::unique_lock lock(wake_mutex);
+		if (stopping)
+		{
+			return;
+		}
+
+		// submit увеличивает queued и только потом берёт wake_mutex и будит, поэтому пробуждение не теряется
+		wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+		if (stopping)
+		{
+			return;
+		}
+	}
+}
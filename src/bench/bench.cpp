@@ -0,0 +1,547 @@
+#include "../../includes/bench/checks.hpp"
+#include "../../includes/bench/harness.hpp"
+#include "../../includes/simulation/reactor_batch.hpp"
+#include "../../includes/simulation/simulation.hpp"
+#include "../../includes/simulation/telemetry.hpp"
+#include "../../includes/simulation/thermodynamics.hpp"
+#include "defs.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using bench::keep;
+
+namespace
+{
+	// Входы меняются от итерации к итерации, чтобы компилятор не свернул вызов в константу
+	constexpr std::size_t INPUTS	 = 1024;
+	constexpr std::size_t INPUT_MASK = INPUTS - 1;
+
+	struct Inputs
+	{
+		std::array<double, INPUTS> temperatures{}; // 280..480 K
+		std::array<double, INPUTS> masses{};	   // 0.5..2.5 кг
+		std::array<double, INPUTS> humidities{};   // 0..100 %
+
+		Inputs()
+		{
+			for (std::size_t i = 0; i < INPUTS; ++i)
+			{
+				const double fraction = static_cast<double>(i) / static_cast<double>(INPUTS);
+				temperatures[i]		  = 280.0 + (200.0 * fraction);
+				masses[i]			  = 0.5 + (2.0 * fraction);
+				humidities[i]		  = 100.0 * fraction;
+			}
+		}
+	};
+
+	void bench_thermodynamics(bench::Runner& runner, const Inputs& in)
+	{
+		const Environment& env = ENV;
+
+		runner.run("thermodynamics/conduction_heat_loss",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_conduction_heat_loss(
+							   env.wall_thermal_conductivity, env.surface_area, env.wall_thickness,
+							   in.temperatures[i & INPUT_MASK], env.ambient_temperature));
+					   }
+				   });
+		runner.run("thermodynamics/convection_heat_loss",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_convection_heat_loss(
+							   env.heat_transfer_coefficient, env.surface_area,
+							   in.temperatures[i & INPUT_MASK], env.ambient_temperature));
+					   }
+				   });
+		runner.run("thermodynamics/radiation_heat_loss",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_radiation_heat_loss(
+							   env.surface_area, in.temperatures[i & INPUT_MASK], env.ambient_temperature));
+					   }
+				   });
+		runner.run("thermodynamics/temperature_change",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_temperature_change(
+							   in.masses[i & INPUT_MASK], env.heat_capacity, 15000.0, 12000.0, 0.1));
+					   }
+				   });
+		runner.run("thermodynamics/mixture_heat_capacity",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_mixture_heat_capacity(
+							   0.5 + (in.masses[i & INPUT_MASK] * 0.1), 0.3));
+					   }
+				   });
+		runner.run("thermodynamics/reaction_heat_rate",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_reaction_heat_rate(in.temperatures[i & INPUT_MASK],
+																			 in.masses[i & INPUT_MASK]));
+					   }
+				   });
+		runner.run("thermodynamics/heat_transfer_coefficient",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_heat_transfer_coefficient(
+							   env.thermal_conductivity, in.masses[i & INPUT_MASK], env.volume,
+							   env.heat_capacity));
+					   }
+				   });
+		runner.run("thermodynamics/latent_heat_rate",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_latent_heat_rate(in.masses[i & INPUT_MASK] - 1.0));
+					   }
+				   });
+		runner.run("thermodynamics/saturation_pressure",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_saturation_pressure(in.temperatures[i & INPUT_MASK]));
+					   }
+				   });
+		runner.run("thermodynamics/saturation_pressure_exact",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_saturation_pressure_exact(
+							   in.temperatures[i & INPUT_MASK]));
+					   }
+				   });
+		runner.run("thermodynamics/max_water_vapor_mass",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_max_water_vapor_mass(in.temperatures[i & INPUT_MASK],
+																			   env.volume));
+					   }
+				   });
+		runner.run("thermodynamics/pressure",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_pressure(env.specific_gas_constant, env.volume,
+																   in.temperatures[i & INPUT_MASK],
+																   in.masses[i & INPUT_MASK], env.pressure));
+					   }
+				   });
+
+		// Производные для якобиана неявных схем
+		runner.run("thermodynamics/radiation_heat_loss_derivative",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_radiation_heat_loss_derivative(
+							   env.surface_area, in.temperatures[i & INPUT_MASK]));
+					   }
+				   });
+		runner.run("thermodynamics/reaction_heat_rate_derivative",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_reaction_heat_rate_derivative(
+							   in.temperatures[i & INPUT_MASK], in.masses[i & INPUT_MASK]));
+					   }
+				   });
+		runner.run("thermodynamics/saturation_pressure_derivative",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_saturation_pressure_derivative(
+							   in.temperatures[i & INPUT_MASK]));
+					   }
+				   });
+		runner.run("thermodynamics/max_water_vapor_mass_derivative",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   keep(Thermodynamics::calculate_max_water_vapor_mass_derivative(
+							   in.temperatures[i & INPUT_MASK], env.volume));
+					   }
+				   });
+
+		// Шаги подсистем над State (как в Simulation::simulate)
+		SharedSimulation simulation = Simulation::shared_simulation();
+		State&			 state		= simulation->state;
+		runner.run("thermodynamics/total_heat_loss",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   state.set_temperature(in.temperatures[i & INPUT_MASK]);
+						   keep(Thermodynamics::calculate_total_heat_loss(state));
+					   }
+				   });
+		runner.run("thermodynamics/update_humidity_with_controller",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   Thermodynamics::update_humidity_with_controller(state, 0.1);
+					   }
+					   keep(state.get_humidity());
+				   });
+		runner.run("thermodynamics/update_temperature_with_controller",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   Thermodynamics::update_temperature_with_controller(state, 0.1);
+					   }
+					   keep(state.get_temperature());
+				   });
+		runner.run("thermodynamics/update_pressure_with_controller",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   Thermodynamics::update_pressure_with_controller(state, 0.1);
+					   }
+					   keep(state.get_pressure());
+				   });
+	}
+
+	void bench_controllers(bench::Runner& runner, const Inputs& in)
+	{
+		SharedSimulation simulation = Simulation::shared_simulation();
+		State&			 state		= simulation->state;
+		const double	 band		= state.get_controller_gains().temperature_band;
+		const double	 pressure_kp = state.get_controller_gains().pressure_kp;
+		const double	 humidity_kp = state.get_controller_gains().humidity_kp;
+
+		runner.run("controller/temperature_parallel_control_output",
+				   [&](std::uint64_t n)
+				   {
+					   TemperatureController& controller = state.get_temperature_controller();
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   state.set_temperature(in.temperatures[i & INPUT_MASK]);
+						   keep(controller.calculate_parallel_control_output(state, band));
+					   }
+				   });
+		// Без кэша прямой связи: окружающая температура (вход кэша) меняется на каждой итерации
+		runner.run("controller/temperature_parallel_control_output_uncached",
+				   [&](std::uint64_t n)
+				   {
+					   TemperatureController& controller = state.get_temperature_controller();
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   state.set_ambient_temperature(in.temperatures[i & INPUT_MASK] - 20.0);
+						   keep(controller.calculate_parallel_control_output(state, band));
+					   }
+				   });
+		runner.run("controller/pressure_mass_flow_output",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   state.set_temperature(in.temperatures[i & INPUT_MASK]);
+						   keep(PressureController::calculate_mass_flow_output(state, 0.1, pressure_kp));
+					   }
+				   });
+		runner.run("controller/humidity_water_injection_rate",
+				   [&](std::uint64_t n)
+				   {
+					   for (std::uint64_t i = 0; i < n; ++i)
+					   {
+						   state.set_humidity(in.humidities[i & INPUT_MASK]);
+						   keep(HumidityController::calculate_water_injection_rate(state, 0.1, 0.02,
+																				   humidity_kp));
+					   }
+				   });
+	}
+
+	// Полный тик Simulation::simulate, включая публикацию снимка и историю
+	void bench_tick(bench::Runner& runner)
+	{
+		constexpr unsigned long TICK_MILLIS = 100;
+		for (auto mode : {IntegratorMode::EULER, IntegratorMode::DORMAND_PRINCE,
+						  IntegratorMode::BACKWARD_EULER, IntegratorMode::BDF2})
+		{
+			const std::string name = "simulate/" + std::string(integrator_name(mode));
+			if (!runner.selected(name))
+			{
+				continue;
+			}
+
+			SharedSimulation simulation = Simulation::shared_simulation();
+			simulation->set_integrator_settings({.mode = mode});
+			simulation->state.set_running(true);
+			runner.run(name,
+					   [&](std::uint64_t n)
+					   {
+						   for (std::uint64_t i = 0; i < n; ++i)
+						   {
+							   simulation->simulate(TICK_MILLIS);
+						   }
+						   keep(simulation->state.get_temperature());
+					   });
+		}
+	}
+
+	// Шаг парка из N реакторов по столбцам; items_per_second - реакторо-шагов в секунду
+	void bench_batch(bench::Runner& runner)
+	{
+		for (std::size_t reactors : {1U, 16U, 256U, 4096U, 65536U})
+		{
+			const std::string name = "batch/step/" + std::to_string(reactors);
+			if (!runner.selected(name))
+			{
+				continue;
+			}
+
+			ReactorBatch batch(reactors);
+			for (std::size_t i = 0; i < reactors; ++i)
+			{
+				Environment env = ENV;
+				env.temperature += static_cast<double>(i % 64);
+				batch.add(env);
+			}
+			runner.run(
+				name,
+				[&](std::uint64_t n)
+				{
+					for (std::uint64_t i = 0; i < n; ++i)
+					{
+						Thermodynamics::step(batch, 0.1);
+					}
+					keep(batch.data(EnvironmentField::TEMPERATURE)[0]);
+				},
+				static_cast<double>(reactors));
+		}
+	}
+
+	void bench_recording(bench::Runner& runner)
+	{
+		if (runner.selected("history/append"))
+		{
+			History		history(history_fields(), HISTORY_CAPACITY);
+			Environment env	 = ENV;
+			unsigned long time = 0;
+			runner.run("history/append",
+					   [&](std::uint64_t n)
+					   {
+						   for (std::uint64_t i = 0; i < n; ++i)
+						   {
+							   env.temperature = 280.0 + static_cast<double>(i & INPUT_MASK);
+							   history.append(time += 100, env);
+						   }
+					   });
+		}
+
+#ifdef REACTOR_POSIX
+		if (runner.selected("telemetry/append"))
+		{
+			// Файл растёт с каждым отсчётом: не больше ~50 МБ за замер, новый файл перед каждым
+			constexpr std::uint64_t MAX_SAMPLES = std::uint64_t{1} << 18;
+			const std::string path =
+				(std::filesystem::temp_directory_path() / "reactor-bench.rtlm").string();
+			Environment						 env = ENV;
+			std::unique_ptr<TelemetryWriter> writer;
+			runner.run_with_setup(
+				"telemetry/append",
+				[&]
+				{
+					writer.reset();
+					writer = std::make_unique<TelemetryWriter>(path);
+				},
+				[&](std::uint64_t n)
+				{
+					for (std::uint64_t i = 0; i < n; ++i)
+					{
+						env.temperature = 280.0 + static_cast<double>(i & INPUT_MASK);
+						writer->append(static_cast<unsigned long>(i * 100), env);
+					}
+				},
+				1.0, MAX_SAMPLES);
+			writer.reset();
+			std::filesystem::remove(path);
+		}
+#endif
+	}
+
+	std::string utc_timestamp()
+	{
+		const std::time_t now = std::time(nullptr);
+		std::tm			  utc{};
+#ifdef _WIN32
+		gmtime_s(&utc, &now);
+#else
+		gmtime_r(&now, &utc);
+#endif
+		std::array<char, 32> buffer{};
+		const std::size_t	 length = std::strftime(buffer.data(), buffer.size(), "%Y-%m-%dT%H:%M:%SZ", &utc);
+		return {buffer.data(), length};
+	}
+
+	void print_usage(std::string_view program)
+	{
+		std::cerr << "Usage: " << program << " [options]\n"
+				  << "  --filter <text>        run only benchmarks whose name contains text\n"
+				  << "  --min-time <ms>        length of one repetition (default 100)\n"
+				  << "  --repetitions <n>      repetitions per benchmark, median is reported (default 5)\n"
+				  << "  --output <path>        write the JSON report there instead of stdout\n"
+				  << "  --quiet                do not print progress to stderr\n"
+				  << "  --check                run the correctness checks instead of benchmarks\n";
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	std::span<char*> args(argv, static_cast<std::size_t>(argc));
+
+	bench::Settings settings;
+	std::string		output_path;
+	bool			quiet = false;
+	bool			check = false;
+
+	try
+	{
+		for (std::size_t i = 1; i < args.size(); ++i)
+		{
+			std::string_view arg = args[i];
+
+			auto next_value = [&]() -> std::string
+			{
+				if (i + 1 >= args.size())
+				{
+					throw std::invalid_argument(std::string("missing value for ") + std::string(arg));
+				}
+				return args[++i];
+			};
+
+			if (arg == "--filter")
+			{
+				settings.filter = next_value();
+			}
+			else if (arg == "--min-time")
+			{
+				settings.min_time = std::chrono::milliseconds(std::stoul(next_value()));
+			}
+			else if (arg == "--repetitions")
+			{
+				settings.repetitions = std::stoul(next_value());
+			}
+			else if (arg == "--output")
+			{
+				output_path = next_value();
+			}
+			else if (arg == "--quiet")
+			{
+				quiet = true;
+			}
+			else if (arg == "--check")
+			{
+				check = true;
+			}
+			else if (arg == "--help" || arg == "-h")
+			{
+				print_usage(args[0]);
+				return EXIT_SUCCESS;
+			}
+			else
+			{
+				throw std::invalid_argument("unknown argument '" + std::string(arg) + "'");
+			}
+		}
+
+		// Таблицы - как в приложении, иначе замеры не соответствуют рабочему режиму
+		ThermoTables<ReactorModel>::install(
+			Thermodynamics::build_tables({.min_temperature = CFG.reaction.min_temp,
+										  .max_temperature = CFG.reaction.max_temp,
+										  .relative_error  = CFG.tables.relative_error}));
+
+		if (check)
+		{
+			return bench::run_checks(std::cerr) ? EXIT_SUCCESS : EXIT_FAILURE;
+		}
+
+		bench::Runner runner(settings, quiet ? nullptr : &std::cerr);
+		const Inputs  inputs;
+
+		bench_thermodynamics(runner, inputs);
+		bench_controllers(runner, inputs);
+		bench_tick(runner);
+		bench_batch(runner);
+		bench_recording(runner);
+
+#ifdef NDEBUG
+		const std::string build = "release";
+#else
+		const std::string build = "debug";
+#endif
+		const std::vector<std::pair<std::string, std::string>> context = {
+			{"date", utc_timestamp()},
+			{"compiler", COMPILER_INFO},
+			{"build", build},
+			{"hardware_threads", std::to_string(std::thread::hardware_concurrency())},
+			{"min_time_ms",
+			 std::to_string(
+				 std::chrono::duration_cast<std::chrono::milliseconds>(settings.min_time).count())},
+			{"repetitions", std::to_string(settings.repetitions)},
+			{"table_relative_error", (std::ostringstream() << CFG.tables.relative_error).str()},
+		};
+
+		if (output_path.empty())
+		{
+			bench::write_json(std::cout, context, runner.get_results());
+		}
+		else
+		{
+			std::ofstream out(output_path);
+			if (!out.is_open())
+			{
+				throw std::runtime_error("Failed to open benchmark output: " + output_path);
+			}
+			bench::write_json(out, context, runner.get_results());
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "reactor-bench: " << e.what() << '\n';
+		print_usage(args[0]);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
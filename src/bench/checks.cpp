@@ -0,0 +1,352 @@
+#include "../../includes/bench/checks.hpp"
+#include "../../includes/simulation/alarms.hpp"
+#include "../../includes/simulation/checkpoint.hpp"
+#include "../../includes/simulation/sweep.hpp"
+#include "../../includes/simulation/telemetry.hpp"
+#include "../../includes/simulation/thermo_kernels.hpp"
+
+#include "defs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace
+{
+	constexpr double NOT_A_NUMBER = std::numeric_limits<double>::quiet_NaN();
+
+	double relative_error(double value, double reference)
+	{
+		return std::abs(value - reference) / std::abs(reference);
+	}
+
+	std::string scientific(double value)
+	{
+		std::ostringstream text;
+		text << std::scientific << std::setprecision(2) << value;
+		return text.str();
+	}
+
+	// Заявленные в thermo_kernels.hpp границы ошибок векторных exp и pow против std::exp
+	// и std::pow на каждом наборе инструкций, который есть у процессора
+	void check_kernel_error_bounds(bench::Checker& checker)
+	{
+		constexpr std::size_t EXP_POINTS = 1 << 16;
+		constexpr double	  EXP_FIRST	 = -708.0;
+		constexpr double	  EXP_LAST	 = 709.0;
+
+		// exp(x) = Аррениус с k0 = m = Q = R = T = 1 и Ea = -x: остальные множители точны
+		std::vector<double> exponents(EXP_POINTS);
+		for (std::size_t i = 0; i < EXP_POINTS; ++i)
+		{
+			exponents[i] = EXP_FIRST + ((EXP_LAST - EXP_FIRST) * static_cast<double>(i) /
+										static_cast<double>(EXP_POINTS - 1));
+		}
+
+		// pow(x, y) = Dittus-Boelter с Re = x, Pr = 1 и C = k = L = 1: h = Re^y
+		constexpr std::size_t		  POW_BASES = 4096;
+		const std::array<double, 7>	  powers{-4.0, -1.5, -0.4, 0.3, 0.8, 2.5, 4.0};
+		std::vector<double>			  bases(POW_BASES);
+		for (std::size_t i = 0; i < POW_BASES; ++i)
+		{
+			// от 1e-3 до 1e6, равномерно по логарифму
+			bases[i] = std::pow(10.0, -3.0 + (9.0 * static_cast<double>(i) /
+											  static_cast<double>(POW_BASES - 1)));
+		}
+		const std::vector<double> pow_ones(POW_BASES, 1.0);
+
+		const kernels::Isa original = kernels::active_isa();
+		for (const kernels::Isa isa : {kernels::Isa::SCALAR, kernels::Isa::AVX2,
+									   kernels::Isa::AVX512})
+		{
+			if (!kernels::set_isa(isa))
+			{
+				continue;
+			}
+			const std::string name(kernels::isa_name(isa));
+
+			// Ea - параметр ядра, поэтому по одной точке; хвост короче вектора считается
+			// тем же векторным кодом с дополнением
+			double worst = 0.0;
+			for (const double exponent : exponents)
+			{
+				const double one = 1.0;
+				double		 out = 0.0;
+				kernels::arrhenius_heat_rate(&one, &one,
+											 {.rate_constant	 = 1.0,
+											  .activation_energy = -exponent,
+											  .gas_constant		 = 1.0,
+											  .heat_of_reaction	 = 1.0},
+											 &out, 1);
+				worst = std::max(worst, relative_error(out, std::exp(exponent)));
+			}
+			checker.expect(worst <= kernels::EXP_MAX_RELATIVE_ERROR,
+						   "kernels: " + name + " exp error " + scientific(worst) +
+							   " is within EXP_MAX_RELATIVE_ERROR on [-708, 709]");
+
+			bool		pow_within = true;
+			std::string pow_worst;
+			for (const double power : powers)
+			{
+				std::vector<double> heat(POW_BASES);
+				kernels::dittus_boelter(pow_ones.data(), bases.data(), pow_ones.data(),
+										pow_ones.data(),
+										{.coefficient			= 1.0,
+										 .reynolds_exponent		= power,
+										 .prandtl_exponent		= 0.0,
+										 .characteristic_length = 1.0,
+										 .flow_velocity			= 1.0,
+										 .viscosity				= 1.0},
+										heat.data(), POW_BASES);
+				for (std::size_t i = 0; i < POW_BASES; ++i)
+				{
+					const double bound = kernels::POW_MAX_RELATIVE_ERROR +
+										 (kernels::POW_RELATIVE_ERROR_PER_UNIT *
+										  std::abs(power * std::log(bases[i])));
+					const double error = relative_error(heat[i], std::pow(bases[i], power));
+					if (error > bound)
+					{
+						pow_within = false;
+						pow_worst  = scientific(bases[i]) + "^" + scientific(power);
+					}
+				}
+			}
+			checker.expect(pow_within, "kernels: " + name + " pow error is within its bound" +
+										   (pow_worst.empty() ? "" : ", fails at " + pow_worst));
+		}
+		kernels::set_isa(original);
+	}
+
+	bool nothing_cleared(const AlarmLog& log)
+	{
+		for (const AlarmEvent& event : log.recent())
+		{
+			if (!event.raised)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Разошедшееся состояние (NaN) - критическая тревога, а не снятие активных
+	void check_alarms_fail_safe(bench::Checker& checker)
+	{
+		const std::vector<SensorRange> sensors = {
+			{"sensor.temperature", EnvironmentField::TEMPERATURE, 273.0, 500.0}};
+		const std::vector<AlarmRuleConfig> configs = {{.name	  = "pressure.rate",
+													   .field	  = "pressure",
+													   .condition = AlarmCondition::RATE_ABOVE,
+													   .threshold = 1000.0}};
+		const auto rules = AlarmRules::compile(configs, sensors);
+
+		Environment env{};
+		env.temperature = 300.0;
+		env.pressure	= 101325.0;
+
+		{
+			AlarmEngine engine(rules);
+			AlarmLog	log;
+			checker.expect(engine.evaluate(100, env, log) == StatusMode::NORMAL,
+						   "alarms: a state inside the ranges is normal");
+
+			env.temperature = 600.0;
+			checker.expect(engine.evaluate(200, env, log) == StatusMode::CRITICAL,
+						   "alarms: a temperature above the sensor range is critical");
+
+			env.temperature = NOT_A_NUMBER;
+			checker.expect(engine.evaluate(300, env, log) == StatusMode::CRITICAL,
+						   "alarms: NaN keeps an active critical alarm");
+			checker.expect(nothing_cleared(log), "alarms: NaN clears no alarm");
+		}
+		{
+			env.temperature = 300.0;
+			AlarmEngine engine(rules);
+			AlarmLog	log;
+			(void) engine.evaluate(100, env, log);
+
+			env.pressure = NOT_A_NUMBER;
+			checker.expect(engine.evaluate(200, env, log) == StatusMode::WARNING,
+						   "alarms: NaN raises a rate rule");
+			env.temperature = NOT_A_NUMBER;
+			checker.expect(engine.evaluate(300, env, log) == StatusMode::CRITICAL,
+						   "alarms: NaN from a normal state raises the sensor range alarm");
+		}
+	}
+
+	bool rejects_run_count(const SweepOptions& options)
+	{
+		try
+		{
+			(void) sweep_run_count(options);
+		}
+		catch (const std::invalid_argument&)
+		{
+			return true;
+		}
+		return false;
+	}
+
+	// Размер серии: переполнение произведения осей не должно превращаться в 0 прогонов
+	void check_sweep_limits(bench::Checker& checker)
+	{
+		SweepOptions options;
+		for (int axis = 0; axis < 4; ++axis)
+		{
+			options.axes.push_back(parse_sweep_axis("reaction.needed_temp=300:400:65536"));
+		}
+		checker.expect(rejects_run_count(options), "sweep: four 65536-point axes are rejected");
+
+		options.axes = {parse_sweep_axis("reaction.needed_temp=300:400:1000000"),
+						parse_sweep_axis("gains.pressure_kp=0:1:1000000")};
+		checker.expect(rejects_run_count(options), "sweep: 1e12 runs are rejected");
+
+		options.axes					 = {parse_sweep_axis("gains.temperature_band=0,-5,50")};
+		options.threads					 = 1;
+		options.batch.duration_seconds = 1.0;
+		const auto table				 = run_sweep(CFG, options);
+		checker.expect(table.rows.size() == 3 && !table.rows[0].error.empty() &&
+						   !table.rows[1].error.empty() && table.rows[2].error.empty(),
+					   "sweep: gains.temperature_band <= 0 fails only its own runs");
+	}
+
+	std::filesystem::path temporary_path(std::string_view extension)
+	{
+		return std::filesystem::temp_directory_path() /
+			   ("reactor-check-" + std::to_string(std::random_device{}()) + std::string(extension));
+	}
+
+	bool same_environment(const Environment& left, const Environment& right)
+	{
+		return std::ranges::all_of(ENVIRONMENT_FIELDS, [&](const auto& field)
+								   { return left.*field.member == right.*field.member; });
+	}
+
+	// Прогон, продолженный из контрольной точки, совпадает с непрерывным бит в бит; счётчики
+	// интегратора и тревога несходимости переживают сохранение
+	void check_checkpoint_round_trip(bench::Checker& checker)
+	{
+		const auto	 path = temporary_path(".chk");
+		BatchOptions options;
+		options.duration_seconds = 60.0;
+		options.integrator.mode	 = IntegratorMode::BDF2;
+
+		const auto original = Simulation::shared_simulation();
+		(void) run_batch(*original, options);
+		IntegratorStats stats = original->get_integrator().get_stats();
+		stats.failed_ticks	  = 3;
+		original->get_integrator().set_stats(stats);
+		original->set_solver_alarm(true);
+		save_checkpoint(*original, path.string());
+
+		const auto restored = Simulation::shared_simulation();
+		restore_checkpoint(*restored, path.string());
+		std::filesystem::remove(path);
+		checker.expect(restored->get_integrator().get_stats().failed_ticks == 3,
+					   "checkpoint: failed ticks are restored");
+		checker.expect(restored->has_solver_alarm(), "checkpoint: the solver alarm is restored");
+
+		(void) run_batch(*original, options);
+		(void) run_batch(*restored, options);
+		checker.expect(!restored->has_solver_alarm(),
+					   "checkpoint: the first good tick clears a restored solver alarm");
+		checker.expect(same_environment(original->state.get_environment(),
+										restored->state.get_environment()) &&
+						   original->get_current_time_millis() ==
+							   restored->get_current_time_millis(),
+					   "checkpoint: a restored run matches the uninterrupted one bit for bit");
+		checker.expect(original->get_integrator().get_stats().accepted_steps ==
+						   restored->get_integrator().get_stats().accepted_steps,
+					   "checkpoint: integrator statistics continue");
+	}
+
+#ifdef REACTOR_POSIX
+	// Круговой прогон телеметрии: что записал TelemetryWriter, то TelemetryReader и отдаёт
+	void check_telemetry_round_trip(bench::Checker& checker)
+	{
+		// Два с половиной блока: индекс из нескольких записей и неполный последний блок
+		constexpr std::uint64_t SAMPLES = (TELEMETRY_BLOCK_SAMPLES * 5) / 2;
+		constexpr std::uint64_t STEP	= 100;
+
+		const auto path = temporary_path(".tlm");
+		auto sample = [](std::uint64_t number)
+		{
+			Environment env{};
+			env.temperature = 300.0 + (static_cast<double>(number) * 0.25);
+			env.pressure	= 101325.0 - static_cast<double>(number);
+			return env;
+		};
+
+		{
+			TelemetryWriter writer(path.string());
+			for (std::uint64_t number = 0; number < SAMPLES; ++number)
+			{
+				writer.append(number * STEP, sample(number));
+			}
+			writer.close();
+			checker.expect(writer.size() == SAMPLES && writer.get_dropped() == 0,
+						   "telemetry: the writer keeps every sample");
+		}
+
+		{
+			const TelemetryReader reader(path.string());
+			checker.expect(reader.size() == SAMPLES, "telemetry: the reader sees every sample");
+			const auto& blocks = reader.blocks();
+			checker.expect(blocks.size() == 3 && blocks.back().last_time == (SAMPLES - 1) * STEP,
+						   "telemetry: the footer index covers every block");
+			checker.expect(reader.field_names().size() == ENVIRONMENT_FIELD_COUNT &&
+							   reader.field_names().front() == ENVIRONMENT_FIELDS[0].name,
+						   "telemetry: field names are stored");
+
+			// Диапазон через границу блоков: два куска, значения совпадают с записанными
+			const std::uint64_t first = TELEMETRY_BLOCK_SAMPLES - 10;
+			const std::uint64_t last  = TELEMETRY_BLOCK_SAMPLES + 9;
+			const auto			slices = reader.range(first * STEP, last * STEP);
+			std::uint64_t		number = first;
+			bool				same   = slices.size() == 2;
+			for (const auto& slice : slices)
+			{
+				const auto temperature = slice.column(EnvironmentField::TEMPERATURE);
+				const auto pressure	   = slice.column(EnvironmentField::PRESSURE);
+				for (std::size_t row = 0; row < slice.times.size(); ++row, ++number)
+				{
+					same = same && slice.times[row] == number * STEP &&
+						   temperature[row] == sample(number).temperature &&
+						   pressure[row] == sample(number).pressure;
+				}
+			}
+			checker.expect(same && number == last + 1,
+						   "telemetry: a range across blocks returns the written values");
+			checker.expect(reader.range(SAMPLES * STEP, SAMPLES * STEP * 2).empty(),
+						   "telemetry: a range after the last sample is empty");
+		}
+
+		std::filesystem::remove(path);
+	}
+#endif
+} // namespace
+
+bool bench::run_checks(std::ostream& log)
+{
+	Checker checker(log);
+
+	check_kernel_error_bounds(checker);
+	check_alarms_fail_safe(checker);
+	check_sweep_limits(checker);
+	check_checkpoint_round_trip(checker);
+#ifdef REACTOR_POSIX
+	check_telemetry_round_trip(checker);
+#endif
+
+	log << "checks: " << checker.get_passed() << " passed, " << checker.get_failed()
+		<< " failed\n";
+	return checker.get_failed() == 0;
+}
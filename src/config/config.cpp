@@ -3,10 +3,13 @@
 
 #include "config_error.hpp"
 
+#include <cstdint>
 #include <filesystem>
 #include <format>
 #include <string>
 #include <toml++/toml.hpp>
+#include <utility>
+#include <vector>
 
 namespace cfg
 {
@@ -128,6 +131,189 @@ namespace cfg
 
 		return rcfg;
 	}
+	// Необязательная секция
+	static TablesConfig load_tables(const toml::table& root)
+	{
+		TablesConfig tcfg;
+		const auto&	 tbl = root["tables"].as_table();
+		if (tbl == nullptr)
+		{
+			return tcfg;
+		}
+
+		tcfg.relative_error =
+			get_optional<double>(*tbl, "relative_error").value_or(tcfg.relative_error);
+		return tcfg;
+	}
+
+	// Необязательная секция
+	static RatesConfig load_rates(const toml::table& root)
+	{
+		RatesConfig rcfg;
+		const auto& tbl = root["rates"].as_table();
+		if (tbl == nullptr)
+		{
+			return rcfg;
+		}
+
+		auto period = [&tbl](std::string_view key, unsigned long fallback) -> unsigned long
+		{
+			const auto value = get_optional<std::int64_t>(*tbl, key);
+			if (!value)
+			{
+				return fallback;
+			}
+			if (*value < 0)
+			{
+				throw ConfigError(std::format("[rates] '{}' must not be negative", key));
+			}
+			return static_cast<unsigned long>(*value);
+		};
+		rcfg.humidity_period_ms	   = period("humidity_period_ms", rcfg.humidity_period_ms);
+		rcfg.temperature_period_ms = period("temperature_period_ms", rcfg.temperature_period_ms);
+		rcfg.pressure_period_ms	   = period("pressure_period_ms", rcfg.pressure_period_ms);
+		return rcfg;
+	}
+
+	// Необязательная секция
+	static TuiConfig load_tui(const toml::table& root)
+	{
+		TuiConfig	tcfg;
+		const auto& tbl = root["tui"].as_table();
+		if (tbl == nullptr)
+		{
+			return tcfg;
+		}
+
+		tcfg.max_fps = get_optional<double>(*tbl, "max_fps").value_or(tcfg.max_fps);
+		if (!(tcfg.max_fps >= MIN_TUI_MAX_FPS))
+		{
+			throw ConfigError(std::format("[tui] 'max_fps' must be at least {}", MIN_TUI_MAX_FPS));
+		}
+		return tcfg;
+	}
+
+	StreamPolicy parse_stream_policy(std::string_view name)
+	{
+		if (name == "block")
+		{
+			return StreamPolicy::BLOCK;
+		}
+		if (name == "drop-oldest")
+		{
+			return StreamPolicy::DROP_OLDEST;
+		}
+		if (name == "decimate")
+		{
+			return StreamPolicy::DECIMATE;
+		}
+		throw ConfigError(
+			std::format("unknown stream policy '{}' (block, drop-oldest, decimate)", name));
+	}
+
+	// Необязательная секция
+	static StreamConfig load_stream(const toml::table& root)
+	{
+		StreamConfig scfg;
+		const auto&	 tbl = root["stream"].as_table();
+		if (tbl == nullptr)
+		{
+			return scfg;
+		}
+
+		if (const auto queue_records = get_optional<std::int64_t>(*tbl, "queue_records"))
+		{
+			if (*queue_records <= 0 ||
+				static_cast<std::uint64_t>(*queue_records) > MAX_STREAM_QUEUE_RECORDS)
+			{
+				throw ConfigError(std::format("[stream] 'queue_records' must be between 1 and {}",
+											  MAX_STREAM_QUEUE_RECORDS));
+			}
+			scfg.queue_records = static_cast<std::size_t>(*queue_records);
+		}
+		if (const auto policy = get_optional<std::string>(*tbl, "policy"))
+		{
+			scfg.policy = parse_stream_policy(*policy);
+		}
+		return scfg;
+	}
+
+	static AlarmCondition parse_alarm_condition(std::string_view name)
+	{
+		if (name == "above")
+		{
+			return AlarmCondition::ABOVE;
+		}
+		if (name == "below")
+		{
+			return AlarmCondition::BELOW;
+		}
+		if (name == "rate_above")
+		{
+			return AlarmCondition::RATE_ABOVE;
+		}
+		if (name == "rate_below")
+		{
+			return AlarmCondition::RATE_BELOW;
+		}
+		throw ConfigError(std::format(
+			"[[alarm]] unknown condition '{}' (above, below, rate_above, rate_below)", name));
+	}
+
+	static AlarmSeverity parse_alarm_severity(std::string_view name)
+	{
+		if (name == "warning")
+		{
+			return AlarmSeverity::WARNING;
+		}
+		if (name == "critical")
+		{
+			return AlarmSeverity::CRITICAL;
+		}
+		throw ConfigError(std::format("[[alarm]] unknown severity '{}' (warning, critical)", name));
+	}
+
+	// Необязательный массив таблиц [[alarm]]; имя поля проверяется при сборке правил
+	static std::vector<AlarmRuleConfig> load_alarms(const toml::table& root)
+	{
+		std::vector<AlarmRuleConfig> alarms;
+		const auto*					 array = root["alarm"].as_array();
+		if (array == nullptr)
+		{
+			return alarms;
+		}
+
+		for (const auto& node : *array)
+		{
+			const auto* tbl = node.as_table();
+			if (tbl == nullptr)
+			{
+				throw ConfigError("[[alarm]] entries must be tables");
+			}
+
+			AlarmRuleConfig rule;
+			rule.name  = get_required<std::string>(*tbl, "name", "alarm");
+			rule.field = get_required<std::string>(*tbl, "field", "alarm");
+			rule.condition =
+				parse_alarm_condition(get_required<std::string>(*tbl, "condition", "alarm"));
+			rule.threshold	= get_required<double>(*tbl, "threshold", "alarm");
+			rule.hysteresis = get_optional<double>(*tbl, "hysteresis").value_or(rule.hysteresis);
+			rule.severity =
+				parse_alarm_severity(get_optional<std::string>(*tbl, "severity").value_or("warning"));
+
+			const auto for_ms = get_optional<std::int64_t>(*tbl, "for_ms").value_or(0);
+			if (for_ms < 0 || rule.hysteresis < 0.0)
+			{
+				throw ConfigError(std::format(
+					"[[alarm]] '{}': for_ms and hysteresis must not be negative", rule.name));
+			}
+			rule.for_ms = static_cast<unsigned long>(for_ms);
+
+			alarms.push_back(std::move(rule));
+		}
+		return alarms;
+	}
+
 	AppConfig load_config(const std::string& path)
 	{
 		namespace fs = std::filesystem;
@@ -173,7 +359,39 @@ namespace cfg
 			ofs << "# specific_gas_constant = 287.0\n";
 			ofs << "# heat_transfer_coefficient = 0.05\n";
 			ofs << "# cooling_rate = 0.0\n";
-			ofs << "# heating_rate = 15000.0\n";
+			ofs << "# heating_rate = 15000.0\n\n";
+
+			ofs << "# Interpolation tables of hot formulas over [min_temp, max_temp]\n";
+			ofs << "# [tables]\n";
+			ofs << "# relative_error = 1e-10 # estimated at sample points; 0 - tables off\n\n";
+
+			ofs << "# Step periods of the subsystems in simulated ms, 0 - once per tick\n";
+			ofs << "# (euler integrator only; the others step the coupled system)\n";
+			ofs << "# [rates]\n";
+			ofs << "# humidity_period_ms = 1000\n";
+			ofs << "# temperature_period_ms = 500\n";
+			ofs << "# pressure_period_ms = 10\n\n";
+
+			ofs << "# Terminal UI: redraws on new state or input, at most max_fps per second\n";
+			ofs << "# [tui]\n";
+			ofs << "# max_fps = 30.0\n\n";
+
+			ofs << "# Streaming output (--stream): queue length in records and what a tick does\n";
+			ofs << "# when the writer falls behind: block, drop-oldest or decimate\n";
+			ofs << "# [stream]\n";
+			ofs << "# queue_records = 4096\n";
+			ofs << "# policy = \"drop-oldest\"\n\n";
+
+			ofs << "# Alarms, any number of [[alarm]] tables. condition: above, below,\n";
+			ofs << "# rate_above, rate_below (units per second); severity: warning, critical\n";
+			ofs << "# [[alarm]]\n";
+			ofs << "# name = \"overheat\"\n";
+			ofs << "# field = \"temperature\"\n";
+			ofs << "# condition = \"above\"\n";
+			ofs << "# threshold = 350.0\n";
+			ofs << "# hysteresis = 2.0 # clears below 348\n";
+			ofs << "# for_ms = 5000     # must hold that long\n";
+			ofs << "# severity = \"critical\"\n";
 		}
 
 		toml::table root;
@@ -190,6 +408,11 @@ namespace cfg
 		cfg.reactor	 = load_reactor(root);
 		cfg.mass	 = load_mass(root);
 		cfg.reaction = load_reaction(root);
+		cfg.tables	 = load_tables(root);
+		cfg.rates	 = load_rates(root);
+		cfg.tui		 = load_tui(root);
+		cfg.stream	 = load_stream(root);
+		cfg.alarms	 = load_alarms(root);
 
 		return cfg;
 	}
@@ -1,24 +1,590 @@
+#include "../includes/shm/shm_ring.hpp"
+#include "../includes/simulation/checkpoint.hpp"
+#include "../includes/simulation/headless.hpp"
 #include "../includes/simulation/simulation.hpp"
+#include "../includes/simulation/stream.hpp"
+#include "../includes/simulation/sweep.hpp"
+#include "../includes/simulation/telemetry.hpp"
 #include "common.hpp"
+#include "tui_options.hpp"
 
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cmath>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <thread>
+#include <utility>
+#include <vector>
 
 using std::thread;
 
-extern void render_tui(State* state);
+extern void render_tui(State* state, const TuiOptions& options);
 
-int main()
+static void print_usage(std::string_view program)
 {
-	SharedSimulation simulation	   = Simulation::shared_simulation();
-	State*			 current_state = &simulation->state;
+	std::cerr << "Usage: " << program << " [--batch <sim-seconds> [--step <ms>] [sweep options]]\n"
+			  << "  --batch <sim-seconds>  run headless as fast as possible and print the result\n"
+			  << "  --headless             run in real time without the TUI until SIGINT/SIGTERM\n"
+			  << "  --step <ms>            length of one simulation step in batch mode (default "
+			  << TIME_OF_TICK << ")\n"
+			  << "  --integrator <name>    euler (default), rk45, backward-euler or bdf2\n"
+			  << "  --rtol <value>         relative tolerance of rk45 (default 1e-6)\n"
+			  << "  --atol <value>         absolute tolerance of rk45 (default 1e-6)\n"
+			  << "  --history <path>       after the batch run write the recorded history as CSV\n"
+			  << "  --telemetry <path>     record every tick into a memory-mapped columnar file\n"
+			  << "  --stream <fmt>:<path>  stream every tick as csv, ndjson or binary to a file\n"
+			  << "                         or to stdout with path - (repeatable)\n"
+			  << "  --stream-policy <name> when the stream writer falls behind: block,\n"
+			  << "                         drop-oldest or decimate (default from [stream])\n"
+			  << "  --stream-queue <n>     stream queue length in records (default from [stream])\n"
+			  << "  --shm <name>           publish every tick into a shared-memory ring (/name)\n"
+			  << "                         for other processes, see reactor-shm-tail; a ring\n"
+			  << "                         another running process writes is not taken over\n"
+			  << "  --checkpoint <path>    save a checkpoint there at exit"
+#ifdef SIGUSR1
+			  << " and on SIGUSR1"
+#endif
+			  << "\n"
+			  << "  --checkpoint-every <sim-seconds>  also save it periodically\n"
+			  << "  --restore <path>       continue from a checkpoint\n"
+			  << "  --max-fps <value>      redraw the TUI at most that often (default from [tui])\n"
+			  << "  --trace <path>         write a Chrome trace-event JSON of ticks, stages and\n"
+			  << "                         TUI frames at exit (open in ui.perfetto.dev)\n"
+			  << "Sweep options (need --batch):\n"
+			  << "  --sweep <axis>         name=start:stop:count, name=v1,v2,...,\n"
+			  << "                         name=uniform:a:b or name=normal:mean:sd (repeatable)\n"
+			  << "  --samples <n>          random samples per grid point (default 1)\n"
+			  << "  --seed <n>             base seed of the per-run random streams (default 0)\n"
+			  << "  --threads <n>          worker threads (default: all hardware threads)\n"
+			  << "  --output <path>        write the CSV table there instead of stdout\n"
+			  << "Sweep parameters:";
+	for (auto name : sweep_parameter_names())
+	{
+		std::cerr << ' ' << name;
+	}
+	std::cerr << '\n';
+}
+
+// Значение option целиком - конечное число: std::stod принял бы "10abc" и "nan"
+static double parse_number(std::string_view option, std::string_view text)
+{
+	double		value = 0.0;
+	const char* last  = text.data() + text.size();
+	const auto [end, error] = std::from_chars(text.data(), last, value);
+	if (error != std::errc{} || end != last || !std::isfinite(value))
+	{
+		throw std::invalid_argument(std::string(option) + " expects a number, got '" +
+									std::string(text) + "'");
+	}
+	return value;
+}
+
+// Значение option целиком - целое не меньше min_value: std::stoul превратил бы "-1" в ULONG_MAX
+template <class T> static T parse_count(std::string_view option, std::string_view text, T min_value)
+{
+	T			value = 0;
+	const char* last  = text.data() + text.size();
+	const auto [end, error] = std::from_chars(text.data(), last, value);
+	if (error == std::errc::result_out_of_range)
+	{
+		throw std::invalid_argument(std::string(option) + " must be at most " +
+									std::to_string(std::numeric_limits<T>::max()) + ", got '" +
+									std::string(text) + "'");
+	}
+	if (error != std::errc{} || end != last || value < min_value)
+	{
+		throw std::invalid_argument(std::string(option) + " expects a whole number >= " +
+									std::to_string(min_value) + ", got '" + std::string(text) +
+									"'");
+	}
+	return value;
+}
+
+static int run_sweep_mode(const SweepOptions& options, const std::string& output_path)
+{
+	SweepTable table = run_sweep(CFG, options);
+
+	if (output_path.empty())
+	{
+		table.write_csv(std::cout);
+	}
+	else
+	{
+		std::ofstream out(output_path);
+		if (!out.is_open())
+		{
+			throw std::runtime_error("Failed to open sweep output: " + output_path);
+		}
+		table.write_csv(out);
+	}
+
+	std::cerr << "sweep: " << table.rows.size() << " runs on " << table.threads << " threads in "
+			  << table.wall_seconds << " s\n";
+	return EXIT_SUCCESS;
+}
+
+// Пишет начальное состояние и каждый следующий тик simulation в telemetry
+static void attach_telemetry(Simulation& simulation, TelemetryWriter& telemetry)
+{
+	telemetry.append(simulation.get_current_time_millis(), simulation.state.get_environment());
+	simulation.add_tick_listener([&telemetry](unsigned long sim_time_millis, const Environment& env)
+								 { telemetry.append(sim_time_millis, env); });
+}
 
+#ifdef SIGUSR1
+namespace
+{
+	std::atomic<Checkpointer*> signal_checkpointer{nullptr};
+
+	// Сама запись - в потоке симуляции, на ближайшем тике
+	extern "C" void request_checkpoint(int /*signal*/)
+	{
+		if (Checkpointer* checkpointer = signal_checkpointer.load())
+		{
+			checkpointer->request();
+		}
+	}
+} // namespace
+#endif
+
+namespace
+{
+	std::atomic_bool stop_requested{false};
+
+	extern "C" void request_stop(int /*signal*/)
+	{
+		stop_requested.store(true);
+	}
+} // namespace
+
+// Симуляция в реальном времени без TUI: данные наружу идут через --stream и --telemetry
+static void run_headless(const SharedSimulation& simulation)
+{
+	const auto POLL_INTERVAL = std::chrono::milliseconds(100);
+
+	std::signal(SIGINT, request_stop);
+	std::signal(SIGTERM, request_stop);
+
+	simulation->state.set_running(true);
 	thread simulation_thread(&Simulation::operator(), simulation);
-	thread tui_thread(render_tui, current_state);
+
+	while (!stop_requested.load())
+	{
+		std::this_thread::sleep_for(POLL_INTERVAL);
+	}
+
+	simulation->state.set_terminated(true);
+	simulation_thread.join();
+
+	std::signal(SIGINT, SIG_DFL);
+	std::signal(SIGTERM, SIG_DFL);
+}
+
+// Пишет начальное состояние и каждый следующий тик simulation в очередь stream
+static void attach_stream(Simulation& simulation, StreamWriter& stream)
+{
+	stream.push(simulation.get_current_time_millis(), simulation.state.get_environment());
+	simulation.add_tick_listener([&stream](unsigned long sim_time_millis, const Environment& env)
+								 { stream.push(sim_time_millis, env); });
+}
+
+// Публикует начальное состояние и каждый следующий тик simulation в кольцо ring
+static void attach_shm(Simulation& simulation, ShmRingWriter& ring)
+{
+	ring.publish(simulation.get_current_time_millis(), simulation.state.get_status_mode(),
+				 simulation.state.get_environment());
+	simulation.add_tick_listener(
+		[&simulation, &ring](unsigned long sim_time_millis, const Environment& env)
+		{ ring.publish(sim_time_millis, simulation.state.get_status_mode(), env); });
+}
+
+static void run_interactive(const SharedSimulation& simulation, const TuiOptions& tui)
+{
+	State* current_state = &simulation->state;
+
+	thread simulation_thread(&Simulation::operator(), simulation);
+	thread tui_thread(render_tui, current_state, std::cref(tui));
 
 	tui_thread.join();
 
 	current_state->set_terminated(true);
 	simulation_thread.join();
+}
+
+int main(int argc, char** argv)
+{
+	std::span<char*> args(argv, static_cast<std::size_t>(argc));
+
+	bool		 batch	  = false;
+	bool		 headless = false;
+	BatchOptions options;
+	SweepOptions sweep;
+	std::string	 output_path;
+	std::string	 history_path;
+	std::string	 telemetry_path;
+	std::string	 checkpoint_path;
+	std::string	 restore_path;
+	std::string	 trace_path;
+	std::string	 shm_name;
+	double		 checkpoint_every = 0.0;
+	TuiOptions	 tui{.max_fps = CFG.tui.max_fps};
+	bool		 integrator_given = false;
+
+	std::vector<StreamSpec> streams;
+	StreamConfig			stream_config = CFG.stream;
+
+	try
+	{
+		for (std::size_t i = 1; i < args.size(); ++i)
+		{
+			std::string_view arg = args[i];
+
+			auto next_value = [&]() -> std::string
+			{
+				if (i + 1 >= args.size())
+				{
+					throw std::invalid_argument(std::string("missing value for ") +
+												std::string(arg));
+				}
+				return args[++i];
+			};
+
+			if (arg == "--batch")
+			{
+				batch					 = true;
+				options.duration_seconds = parse_number(arg, next_value());
+				if (options.duration_seconds < 0.0 || options.duration_seconds > MAX_BATCH_SECONDS)
+				{
+					throw std::invalid_argument("--batch must be between 0 and 1e12 seconds");
+				}
+			}
+			else if (arg == "--headless")
+			{
+				headless = true;
+			}
+			else if (arg == "--step")
+			{
+				options.step_millis = parse_count<unsigned long>(arg, next_value(), 1);
+			}
+			else if (arg == "--integrator")
+			{
+				options.integrator.mode = parse_integrator_mode(next_value());
+				integrator_given		= true;
+			}
+			else if (arg == "--rtol")
+			{
+				options.integrator.relative_tolerance = parse_number(arg, next_value());
+				integrator_given					  = true;
+				if (options.integrator.relative_tolerance <= 0.0)
+				{
+					throw std::invalid_argument("--rtol must be positive");
+				}
+			}
+			else if (arg == "--atol")
+			{
+				options.integrator.absolute_tolerance = parse_number(arg, next_value());
+				integrator_given					  = true;
+				if (options.integrator.absolute_tolerance <= 0.0)
+				{
+					throw std::invalid_argument("--atol must be positive");
+				}
+			}
+			else if (arg == "--sweep")
+			{
+				sweep.axes.push_back(parse_sweep_axis(next_value()));
+			}
+			else if (arg == "--samples")
+			{
+				sweep.samples = parse_count<std::size_t>(arg, next_value(), 1);
+				if (sweep.samples > MAX_SWEEP_RUNS)
+				{
+					throw std::invalid_argument("--samples must be at most " +
+												std::to_string(MAX_SWEEP_RUNS));
+				}
+			}
+			else if (arg == "--seed")
+			{
+				sweep.seed = parse_count<std::uint64_t>(arg, next_value(), 0);
+			}
+			else if (arg == "--threads")
+			{
+				sweep.threads = parse_count<std::size_t>(arg, next_value(), 0);
+				if (sweep.threads > MAX_SWEEP_THREADS)
+				{
+					throw std::invalid_argument("--threads must be at most " +
+												std::to_string(MAX_SWEEP_THREADS));
+				}
+			}
+			else if (arg == "--checkpoint")
+			{
+				checkpoint_path = next_value();
+			}
+			else if (arg == "--checkpoint-every")
+			{
+				checkpoint_every = parse_number(arg, next_value());
+				if (checkpoint_every < 0.0 || checkpoint_every > MAX_BATCH_SECONDS)
+				{
+					throw std::invalid_argument("--checkpoint-every must be between 0 and 1e12 "
+												"seconds");
+				}
+			}
+			else if (arg == "--restore")
+			{
+				restore_path = next_value();
+			}
+			else if (arg == "--max-fps")
+			{
+				tui.max_fps = parse_number(arg, next_value());
+				if (tui.max_fps < MIN_TUI_MAX_FPS)
+				{
+					throw std::invalid_argument("--max-fps must be at least 0.1");
+				}
+			}
+			else if (arg == "--trace")
+			{
+				trace_path = next_value();
+			}
+			else if (arg == "--telemetry")
+			{
+				telemetry_path = next_value();
+			}
+			else if (arg == "--stream")
+			{
+				streams.push_back(parse_stream_spec(next_value()));
+			}
+			else if (arg == "--stream-policy")
+			{
+				stream_config.policy = cfg::parse_stream_policy(next_value());
+			}
+			else if (arg == "--stream-queue")
+			{
+				stream_config.queue_records = parse_count<std::size_t>(arg, next_value(), 1);
+				if (stream_config.queue_records > MAX_STREAM_QUEUE_RECORDS)
+				{
+					throw std::invalid_argument("--stream-queue must be at most " +
+												std::to_string(MAX_STREAM_QUEUE_RECORDS));
+				}
+			}
+			else if (arg == "--shm")
+			{
+				shm_name = next_value();
+			}
+			else if (arg == "--history")
+			{
+				history_path = next_value();
+			}
+			else if (arg == "--output")
+			{
+				output_path = next_value();
+			}
+			else if (arg == "--help" || arg == "-h")
+			{
+				print_usage(args[0]);
+				return EXIT_SUCCESS;
+			}
+			else
+			{
+				throw std::invalid_argument("unknown argument " + std::string(arg));
+			}
+		}
+
+		// До запуска потоков: таблицы читаются из симуляции без синхронизации
+		ThermoTables<ReactorModel>::install(
+			Thermodynamics::build_tables({.min_temperature = CFG.reaction.min_temp,
+										  .max_temperature = CFG.reaction.max_temp,
+										  .relative_error  = CFG.tables.relative_error}));
+
+		if (!batch && !sweep.axes.empty())
+		{
+			throw std::invalid_argument("--sweep needs --batch <sim-seconds>");
+		}
+		if (batch && headless)
+		{
+			throw std::invalid_argument("--headless (real time) and --batch can't be combined");
+		}
+		if (checkpoint_every > 0.0 && checkpoint_path.empty())
+		{
+			throw std::invalid_argument("--checkpoint-every needs --checkpoint <path>");
+		}
+
+		if (!trace_path.empty())
+		{
+			if constexpr (!PROFILING_ENABLED)
+			{
+				throw std::invalid_argument("--trace needs a build with REACTOR_PROFILING");
+			}
+			// До запуска потоков симуляции и TUI, чтобы их отрезки шли от одного начала
+			Tracer::start();
+			Tracer::set_thread_name("main");
+		}
+		auto finish_trace = [&trace_path]
+		{
+			if (!trace_path.empty())
+			{
+				Tracer::stop();
+				Tracer::write_file(trace_path);
+			}
+		};
+
+		if (!sweep.axes.empty())
+		{
+			if (!telemetry_path.empty() || !checkpoint_path.empty() || !restore_path.empty() ||
+				!streams.empty() || !shm_name.empty())
+			{
+				throw std::invalid_argument("--telemetry, --stream, --shm, --checkpoint and "
+											"--restore work with a single run, not a sweep");
+			}
+			sweep.batch	   = options;
+			const int code = run_sweep_mode(sweep, output_path);
+			finish_trace();
+			return code;
+		}
+
+		SharedSimulation simulation = Simulation::shared_simulation();
+		if (!restore_path.empty())
+		{
+			restore_checkpoint(*simulation, restore_path);
+			if (!integrator_given)
+			{
+				// Без явного --integrator продолжаем той же схемой, что была в контрольной точке
+				options.integrator = simulation->get_integrator().get_settings();
+			}
+		}
+		simulation->set_integrator_settings(options.integrator);
+
+		std::unique_ptr<TelemetryWriter> telemetry;
+		if (!telemetry_path.empty())
+		{
+			telemetry = std::make_unique<TelemetryWriter>(telemetry_path);
+			attach_telemetry(*simulation, *telemetry);
+		}
+
+		std::unique_ptr<StreamWriter> stream;
+		bool						  stdout_streamed = false;
+		if (!streams.empty())
+		{
+			std::vector<std::unique_ptr<StreamSink>> sinks;
+			for (const StreamSpec& spec : streams)
+			{
+				if (spec.is_stdout() && !batch && !headless)
+				{
+					throw std::invalid_argument("--stream to stdout needs --batch or --headless");
+				}
+				if (spec.is_stdout() && std::exchange(stdout_streamed, true))
+				{
+					throw std::invalid_argument("only one --stream can write to stdout");
+				}
+				sinks.push_back(make_stream_sink(spec));
+			}
+			stream = std::make_unique<StreamWriter>(std::move(sinks), stream_config.queue_records,
+													stream_config.policy);
+			attach_stream(*simulation, *stream);
+		}
+
+		std::unique_ptr<ShmRingWriter> shm;
+		if (!shm_name.empty())
+		{
+			shm = std::make_unique<ShmRingWriter>(shm_name, SHM_RING_DEFAULT_CAPACITY);
+			attach_shm(*simulation, *shm);
+		}
+
+		std::unique_ptr<Checkpointer> checkpointer;
+		if (!checkpoint_path.empty())
+		{
+			const double MILLIS_IN_SEC = 1000.0;
+			checkpointer			   = std::make_unique<Checkpointer>(
+				  *simulation, checkpoint_path,
+				  static_cast<unsigned long>(std::llround(checkpoint_every * MILLIS_IN_SEC)));
+			simulation->add_tick_listener(
+				[&checkpointer](unsigned long sim_time_millis, const Environment& env)
+				{ (*checkpointer)(sim_time_millis, env); });
+#ifdef SIGUSR1
+			signal_checkpointer.store(checkpointer.get());
+			std::signal(SIGUSR1, request_checkpoint);
+#endif
+		}
+
+		if (headless)
+		{
+			run_headless(simulation);
+		}
+		else if (!batch)
+		{
+			run_interactive(simulation, tui);
+		}
+		else
+		{
+			BatchReport report = run_batch(*simulation, options);
+			// stdout занят потоком записей - отчёт уходит в stderr
+			print_report(stdout_streamed ? std::cerr : std::cout, *simulation, report);
+
+			if (!history_path.empty())
+			{
+				std::ofstream out(history_path);
+				if (!out.is_open())
+				{
+					throw std::runtime_error("Failed to open history output: " + history_path);
+				}
+				write_history_csv(out, simulation->state.get_history());
+			}
+		}
+
+		if (telemetry)
+		{
+			telemetry->close();
+			if (telemetry->get_dropped() > 0)
+			{
+				std::cerr << "telemetry: " << telemetry->get_dropped() << " samples dropped after "
+						  << telemetry->size() << " written: " << telemetry->get_error() << '\n';
+			}
+		}
+		if (stream)
+		{
+			stream->close();
+			const StreamWriter::Stats stats = stream->get_stats();
+			std::cerr << "stream: " << stats.written << " records written, " << stats.dropped
+					  << " dropped, " << stats.decimated << " decimated\n";
+		}
+		if (checkpointer)
+		{
+#ifdef SIGUSR1
+			std::signal(SIGUSR1, SIG_DFL);
+			signal_checkpointer.store(nullptr);
+#endif
+			if (checkpointer->get_failed() > 0)
+			{
+				std::cerr << "checkpoint: " << checkpointer->get_failed()
+						  << " periodic saves failed, last: " << checkpointer->get_last_error()
+						  << '\n';
+			}
+			save_checkpoint(*simulation, checkpoint_path);
+		}
+		finish_trace();
+	}
+	catch (const std::invalid_argument& e)
+	{
+		// Неверные аргументы: подсказка по использованию к месту
+		std::cerr << "reactor: " << e.what() << '\n';
+		print_usage(args[0]);
+		return EXIT_FAILURE;
+	}
+	catch (const std::exception& e)
+	{
+		// Ошибки ввода-вывода, контрольных точек, телеметрии - аргументы тут ни при чём
+		std::cerr << "reactor: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
 
-	return 0;
+	return EXIT_SUCCESS;
 }
@@ -0,0 +1,336 @@
+#include "../../includes/shm/shm_ring.hpp"
+
+#include "defs.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#ifdef REACTOR_POSIX
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	static_assert(sizeof(ShmRingHeader) % alignof(ShmSlot) == 0);
+
+	std::size_t ring_bytes(std::uint64_t capacity)
+	{
+		return sizeof(ShmRingHeader) + (static_cast<std::size_t>(capacity) * sizeof(ShmSlot));
+	}
+
+	// error - errno, сохранённый до close/shm_unlink: они его перезаписывают
+	[[noreturn]] void fail(const std::string& what, const std::string& name, int error)
+	{
+		throw ShmRingError("shm ring: " + what + " '" + name + "': " + std::strerror(error));
+	}
+
+#ifdef REACTOR_POSIX
+	// Процесс, который ещё пишет в кольцо name, или 0: кольца нет, оно закрыто, не наше
+	// или его писатель завершился, не закрыв его (упал)
+	pid_t live_writer(const std::string& name)
+	{
+		const int file = ::shm_open(name.c_str(), O_RDONLY, 0);
+		if (file < 0)
+		{
+			return 0;
+		}
+
+		pid_t		writer = 0;
+		struct stat info{};
+		if (::fstat(file, &info) == 0 &&
+			static_cast<std::size_t>(info.st_size) >= sizeof(ShmRingHeader))
+		{
+			void* address = ::mmap(nullptr, sizeof(ShmRingHeader), PROT_READ, MAP_SHARED, file, 0);
+			if (address != MAP_FAILED)
+			{
+				const auto* header = static_cast<const ShmRingHeader*>(address);
+				if (header->magic == SHM_RING_MAGIC &&
+					header->closed.load(std::memory_order_acquire) == 0 && header->writer_pid > 0 &&
+					(::kill(header->writer_pid, 0) == 0 || errno == EPERM))
+				{
+					writer = header->writer_pid;
+				}
+				::munmap(address, sizeof(ShmRingHeader));
+			}
+		}
+		::close(file);
+		return writer;
+	}
+#endif
+} // namespace
+
+#ifdef REACTOR_POSIX
+
+ShmRingWriter::ShmRingWriter(const std::string& name, std::size_t capacity) : name(name)
+{
+	const std::uint64_t slots_count = std::bit_ceil(std::max<std::uint64_t>(capacity, 2));
+	mapped_bytes					= ring_bytes(slots_count);
+
+	// Кольцо прошлого запуска (в том числе упавшего) заменяется новым объектом; читатели,
+	// подключённые к старому, дочитывают его и переподключаются по имени. Кольцо другого
+	// работающего процесса не трогаем: его читатели молча перешли бы на наше
+	if (const pid_t writer = live_writer(name); writer != 0)
+	{
+		throw ShmRingError("shm ring: '" + name + "' is in use by running process " +
+						   std::to_string(writer) + ", choose another --shm name");
+	}
+	::shm_unlink(name.c_str());
+	file = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+	if (file < 0)
+	{
+		fail("failed to create", name, errno);
+	}
+	if (::ftruncate(file, static_cast<off_t>(mapped_bytes)) != 0)
+	{
+		const int error = errno;
+		::close(file);
+		::shm_unlink(name.c_str());
+		fail("failed to size", name, error);
+	}
+	mapping = ::mmap(nullptr, mapped_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+	if (mapping == MAP_FAILED)
+	{
+		const int error = errno;
+		mapping			= nullptr;
+		::close(file);
+		::shm_unlink(name.c_str());
+		fail("failed to map", name, error);
+	}
+
+	// Объект только что создан и заполнен нулями; читатель проверяет метку, её пишем последней
+	header				 = new (mapping) ShmRingHeader{};
+	header->field_count	 = ENVIRONMENT_FIELD_COUNT;
+	header->record_words = SHM_RECORD_WORDS;
+	header->capacity	 = slots_count;
+	header->writer_pid	 = ::getpid();
+	for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		const std::string_view field_name = ENVIRONMENT_FIELDS[field].name;
+		std::memcpy(header->names[field].data(), field_name.data(),
+					std::min(field_name.size(), SHM_RING_NAME_LENGTH - 1));
+	}
+
+	slots = reinterpret_cast<ShmSlot*>(static_cast<std::byte*>(mapping) + sizeof(ShmRingHeader)); // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+	std::uninitialized_value_construct_n(slots, slots_count);
+	mask = slots_count - 1;
+
+	std::atomic_thread_fence(std::memory_order_release);
+	header->magic = SHM_RING_MAGIC;
+}
+
+ShmRingWriter::~ShmRingWriter()
+{
+	if (header != nullptr)
+	{
+		header->closed.store(1, std::memory_order_release);
+	}
+	if (mapping != nullptr)
+	{
+		::munmap(mapping, mapped_bytes);
+	}
+	if (file >= 0)
+	{
+		::close(file);
+		::shm_unlink(name.c_str());
+	}
+}
+
+ShmRingReader::ShmRingReader(const std::string& name)
+{
+	file = ::shm_open(name.c_str(), O_RDONLY, 0);
+	if (file < 0)
+	{
+		fail("failed to open", name, errno);
+	}
+
+	struct stat info{};
+	if (::fstat(file, &info) != 0)
+	{
+		const int error = errno;
+		::close(file);
+		fail("failed to stat", name, error);
+	}
+	mapped_bytes = static_cast<std::size_t>(info.st_size);
+	if (mapped_bytes < sizeof(ShmRingHeader))
+	{
+		::close(file);
+		throw ShmRingError("shm ring: '" + name + "' is too short");
+	}
+
+	void* address = ::mmap(nullptr, mapped_bytes, PROT_READ, MAP_SHARED, file, 0);
+	if (address == MAP_FAILED)
+	{
+		const int error = errno;
+		::close(file);
+		fail("failed to map", name, error);
+	}
+	mapping = address;
+	header	= static_cast<const ShmRingHeader*>(address);
+
+	std::string problem;
+	if (header->magic != SHM_RING_MAGIC || header->record_words != SHM_RECORD_WORDS)
+	{
+		problem = "is not a reactor shm ring (or is still being created)";
+	}
+	else if (header->field_count != ENVIRONMENT_FIELD_COUNT)
+	{
+		problem = "has " + std::to_string(header->field_count) + " fields, expected " +
+				  std::to_string(ENVIRONMENT_FIELD_COUNT);
+	}
+	else if (!std::has_single_bit(header->capacity) || ring_bytes(header->capacity) != mapped_bytes)
+	{
+		problem = "has a broken size";
+	}
+	for (std::size_t field = 0; problem.empty() && field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		const auto& stored = header->names[field];
+		if (std::string_view(stored.data(), strnlen(stored.data(), stored.size())) !=
+			ENVIRONMENT_FIELDS[field].name)
+		{
+			problem = "has fields in a different order than Environment";
+		}
+	}
+	if (!problem.empty())
+	{
+		::munmap(address, mapped_bytes);
+		::close(file);
+		throw ShmRingError("shm ring: '" + name + "' " + problem);
+	}
+
+	slots  = reinterpret_cast<const ShmSlot*>(static_cast<const std::byte*>(address) + // NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+											  sizeof(ShmRingHeader));
+	mask   = header->capacity - 1;
+	cursor = head();
+}
+
+ShmRingReader::~ShmRingReader()
+{
+	if (mapping != nullptr)
+	{
+		::munmap(const_cast<void*>(mapping), mapped_bytes); // NOLINT(cppcoreguidelines-pro-type-const-cast)
+	}
+	if (file >= 0)
+	{
+		::close(file);
+	}
+}
+
+#else
+
+ShmRingWriter::ShmRingWriter(const std::string& name, std::size_t /*capacity*/) : name(name)
+{
+	throw ShmRingError("shm ring: shared memory needs a POSIX system");
+}
+
+ShmRingWriter::~ShmRingWriter() = default;
+
+ShmRingReader::ShmRingReader(const std::string& /*name*/)
+{
+	throw ShmRingError("shm ring: shared memory needs a POSIX system");
+}
+
+ShmRingReader::~ShmRingReader() = default;
+
+#endif
+
+void ShmRingWriter::publish(unsigned long sim_time_millis, StatusMode status,
+							const Environment& env)
+{
+	const std::uint64_t sequence = next;
+	ShmSlot&			slot	 = slots[sequence & mask];
+
+	slot.sequence.store((2 * sequence) + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	slot.words[SHM_RECORD_TIME_WORD].store(sim_time_millis, std::memory_order_relaxed);
+	slot.words[SHM_RECORD_STATUS_WORD].store(static_cast<std::uint64_t>(status),
+											 std::memory_order_relaxed);
+	for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+	{
+		slot.words[SHM_RECORD_FIELD_WORD + field].store(
+			std::bit_cast<std::uint64_t>(env.*ENVIRONMENT_FIELDS[field].member),
+			std::memory_order_relaxed);
+	}
+
+	slot.sequence.store((2 * sequence) + 2, std::memory_order_release);
+	header->head.store(sequence + 1, std::memory_order_release);
+	next = sequence + 1;
+}
+
+void ShmRingReader::skip_overwritten(std::uint64_t head)
+{
+	// Слот записи head писатель может уже переписывать: целы последние capacity - 1 записей
+	const std::uint64_t intact = mask;
+	if (head - cursor > intact)
+	{
+		lost += head - intact - cursor;
+		cursor = head - intact;
+	}
+}
+
+std::optional<ShmRingReader::View> ShmRingReader::peek()
+{
+	const std::uint64_t published = head();
+	if (cursor >= published)
+	{
+		return std::nullopt;
+	}
+	skip_overwritten(published);
+
+	const ShmSlot* slot = &slots[cursor & mask];
+	return View(slot, cursor, slot->sequence.load(std::memory_order_acquire));
+}
+
+bool ShmRingReader::commit(const View& view)
+{
+	std::atomic_thread_fence(std::memory_order_acquire);
+	const std::uint64_t after = view.slot->sequence.load(std::memory_order_relaxed);
+	if (view.stamp == (2 * view.seq) + 2 && after == view.stamp)
+	{
+		cursor = view.seq + 1;
+		return true;
+	}
+
+	// Слот занят более новой записью: писатель ушёл вперёд минимум на кольцо
+	skip_overwritten(head());
+	return false;
+}
+
+std::optional<ShmRecord> ShmRingReader::next()
+{
+	while (auto view = peek())
+	{
+		ShmRecord record{.sequence		  = view->sequence(),
+						 .sim_time_millis = view->sim_time_millis(),
+						 .status		  = view->status(),
+						 .environment	  = {}};
+		for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+		{
+			record.environment.*ENVIRONMENT_FIELDS[field].member =
+				view->field(static_cast<EnvironmentField>(field));
+		}
+		if (commit(*view))
+		{
+			return record;
+		}
+	}
+	return std::nullopt;
+}
+
+void ShmRingReader::seek_oldest()
+{
+	const std::uint64_t published = head();
+	cursor						  = published > mask ? published - mask : 0;
+}
+
+void ShmRingReader::seek_latest()
+{
+	cursor = head();
+}
@@ -0,0 +1,109 @@
+#include "../../includes/shm/shm_ring.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <limits>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Пример потребителя кольца: печатает записи в CSV по мере публикации, пока писатель не
+// завершится
+int main(int argc, char** argv)
+{
+	const auto POLL_INTERVAL = std::chrono::milliseconds(10);
+
+	std::span<char*> args(argv, static_cast<std::size_t>(argc));
+
+	bool		from_oldest = false;
+	std::string name;
+	for (std::size_t i = 1; i < args.size(); ++i)
+	{
+		const std::string_view arg = args[i];
+		if (arg == "--from-oldest")
+		{
+			from_oldest = true;
+		}
+		else if (name.empty() && !arg.starts_with("--"))
+		{
+			name = arg;
+		}
+		else
+		{
+			name.clear();
+			break;
+		}
+	}
+	if (name.empty())
+	{
+		std::cerr << "Usage: " << args[0] << " [--from-oldest] <shm-name>\n"
+				  << "  print the records of a reactor --shm ring as CSV until the writer exits\n";
+		return EXIT_FAILURE;
+	}
+
+	try
+	{
+		ShmRingReader reader(name);
+		if (from_oldest)
+		{
+			reader.seek_oldest();
+		}
+
+		std::cout.precision(std::numeric_limits<double>::max_digits10);
+		std::cout << "sequence,time_ms,status";
+		for (const auto& field : ENVIRONMENT_FIELDS)
+		{
+			std::cout << ',' << field.name;
+		}
+		std::cout << '\n';
+
+		std::array<double, ENVIRONMENT_FIELD_COUNT> values{};
+		while (true)
+		{
+			const auto view = reader.peek();
+			if (!view)
+			{
+				if (reader.is_closed())
+				{
+					break;
+				}
+				std::cout.flush();
+				std::this_thread::sleep_for(POLL_INTERVAL);
+				continue;
+			}
+
+			// Поля читаются прямо из слота; печатаем, только если commit подтвердил, что слот
+			// не перезаписали во время чтения
+			const std::uint64_t sim_time_millis = view->sim_time_millis();
+			const StatusMode	status			= view->status();
+			for (std::size_t field = 0; field < ENVIRONMENT_FIELD_COUNT; ++field)
+			{
+				values[field] = view->field(static_cast<EnvironmentField>(field));
+			}
+			if (!reader.commit(*view))
+			{
+				continue;
+			}
+
+			std::cout << view->sequence() << ',' << sim_time_millis << ',' << status_name(status);
+			for (const double value : values)
+			{
+				std::cout << ',' << value;
+			}
+			std::cout << '\n';
+		}
+
+		std::cerr << "shm: " << reader.head() << " records published, " << reader.lost_records()
+				  << " lost to lag\n";
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "reactor-shm-tail: " << e.what() << '\n';
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
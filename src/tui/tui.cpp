@@ -1,18 +1,23 @@
 #include "common.hpp"
 
+#include <chrono>
+#include <cstdint>
 #include <ftxui/component/component.hpp>
 #include <ftxui/component/screen_interactive.hpp>
 #include <ftxui/dom/elements.hpp>
 #include <ftxui/dom/flexbox_config.hpp>
+#include <iomanip>
+#include <sstream>
+#include <stop_token>
+#include <thread>
 #include <tui.hpp>
 
 using namespace tui;
 using namespace ftxui;
-using namespace std::chrono_literals;
 
-void render_tui(State* state)
+void render_tui(State* state, const TuiOptions& options)
 {
-	Instance instance(state);
+	Instance instance(state, options);
 	instance.display();
 }
 
@@ -20,28 +25,46 @@ void Instance::display()
 {
 	auto screen = ScreenInteractive::Fullscreen();
 
+	Tracer::set_thread_name("render");
+
 	Bar	 bar(state);
 	auto bar_renderer = bar.component();
 
 	auto root = Renderer(bar_renderer,
-						 [&screen, bar_renderer]
+						 [bar_renderer]
 						 {
-							 screen.RequestAnimationFrame();
+							 const TraceScope span("Frame");
 							 return vbox({bar_renderer->Render()}) | border;
 						 });
 
-	std::thread sleeper(
-		[]
+	// Ввод FTXUI перерисовывает сам. Кроме него кадр нужен, только когда симуляция
+	// опубликовала новый снимок или в журнале тревог появилось событие: поток сверяет версии
+	// не чаще max_fps раз в секунду и будит цикл пустым событием. Пауза - ни одного кадра
+	const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+		std::chrono::duration<double>(1.0 / options.max_fps));
+	std::jthread refresher(
+		[this, &screen, period](const std::stop_token& stop)
 		{
-			while (true)
+			std::uint64_t seen_snapshot = state->snapshot_version();
+			std::uint64_t seen_alarms	= state->get_alarm_log().version();
+			while (!stop.stop_requested())
 			{
-				std::this_thread::sleep_for(50ms);
+				std::this_thread::sleep_for(period);
+
+				const std::uint64_t snapshot = state->snapshot_version();
+				const std::uint64_t alarms	 = state->get_alarm_log().version();
+				if (snapshot != seen_snapshot || alarms != seen_alarms)
+				{
+					seen_snapshot = snapshot;
+					seen_alarms	  = alarms;
+					screen.PostEvent(Event::Custom);
+				}
 			}
 		});
 
 	screen.Loop(root);
 
-	sleeper.detach();
+	refresher.request_stop();
 }
 
 Component Bar::component()
@@ -51,7 +74,8 @@ Component Bar::component()
 	FlexboxConfig config;
 	config.direction = FlexboxConfig::Direction::Column;
 
-	auto tab_container = Container::Tab({main_component, stat_component}, &tab_selected);
+	auto tab_container = Container::Tab(
+		{main_component, stat_component, profile_component, alarm_component}, &tab_selected);
 
 	auto tab_filled = Renderer(tab_container, [tab_container]
 							   { return tab_container->Render() | yflex | xflex | frame; });
@@ -115,8 +139,92 @@ Component StatWindow::component()
 	return Renderer(
 		[this]
 		{
+			// Одна согласованная копия на кадр, симуляцию при этом не ждём
+			frame = state->snapshot();
 			indicators.get_content().rerender_all();
+			graphs.get_content().rerender_all();
+
+			Element indicators_element = indicators.element();
+			Element graphs_element	   = graphs.element();
+			if (indicators_element != shown_indicators || graphs_element != shown_graphs || !layout)
+			{
+				layout			 = hbox({indicators_element | flex, graphs_element | flex});
+				shown_indicators = std::move(indicators_element);
+				shown_graphs	 = std::move(graphs_element);
+			}
+			return layout;
+		});
+}
+
+Component ProfileWindow::component()
+{
+	return Renderer(
+		[this]
+		{
+			stages.get_content().rerender_all();
+			return stages.element() | flex;
+		});
+}
+
+namespace
+{
+	Color severity_color(StatusMode mode)
+	{
+		switch (mode)
+		{
+		case StatusMode::NORMAL:
+			return Color::Green;
+		case StatusMode::WARNING:
+			return Color::Yellow;
+		case StatusMode::CRITICAL:
+			return Color::Red;
+		}
+		return Color::Default;
+	}
+
+	Element alarm_line(const AlarmEvent& event, bool with_action)
+	{
+		std::ostringstream line;
+		line << std::setw(10) << event.sim_time_millis / 1000.0 << " s  ";
+		if (with_action)
+		{
+			line << (event.raised ? "raised   " : "cleared  ");
+		}
+		line << event.name << " = " << event.value;
+		return text(line.str()) | color(severity_color(event.severity));
+	}
+} // namespace
+
+Component AlarmWindow::component()
+{
+	return Renderer(
+		[this]
+		{
+			refresh();
+
+			const StatusMode status = state->snapshot().status_mode;
+			Elements		 active_lines;
+			for (const AlarmEvent& alarm : active)
+			{
+				active_lines.push_back(alarm_line(alarm, false));
+			}
+			if (active_lines.empty())
+			{
+				active_lines.push_back(text("none") | dim);
+			}
+
+			Elements event_lines;
+			for (const AlarmEvent& event : events)
+			{
+				event_lines.push_back(alarm_line(event, true));
+			}
 
-			return indicators.element();
+			return vbox({
+				hbox({text(" STATUS: "), text(std::string(status_name(status))) | bold |
+											 color(severity_color(status))}),
+				separator(),
+				window(text("Active"), vbox(std::move(active_lines))),
+				window(text("Events"), vbox(std::move(event_lines)) | flex),
+			});
 		});
 }